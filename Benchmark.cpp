@@ -0,0 +1,607 @@
+#include "convexhull.h"
+
+//Benchmark for the output sensitive engines: n is kept fixed while the number of
+//hull vertices h grows, for an O(n log h) engine the time per point should follow
+//log h and flatten out, not stay at the O(n log n) level for every h.
+//Build and run : g++ -O2 -std=c++17 Benchmark.cpp -o benchmark && ./benchmark [n]
+//./benchmark n predicates times the floating point predicates instead.
+//./benchmark suite [maxn] [csv|json] [seed] runs every engine on the seeded
+//workloads below instead, see suite().
+//./benchmark dynamic [n] [ops] [seed] compares DynamicHull with rebuilding, see
+//dynamicBenchmark().
+//./benchmark window [n] [seed] reports the latency percentiles of SlidingHull,
+//see windowBenchmark().
+//./benchmark batch [sets] [seed] reports hulls/second of BatchHull, see
+//batchBenchmark().
+
+//Allocation counter for the suite, every operator new of the process goes
+//through it
+atomic<long long> allocations{0};
+
+void *operator new(size_t size)
+{
+    allocations++;
+    if(void *p = malloc(size ? size : 1))
+        return p;
+    throw bad_alloc();
+}
+
+//The operator new above gets its memory from malloc, so free is the matching
+//release. GCC only sees the inlined new expression and warns under -Wall.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+#pragma GCC diagnostic pop
+
+//Utility function to generate n points of which about h are on the convex hull.
+//h points are placed on a circle of radius r and the remaining points are spread
+//strictly inside the polygon they form.
+vector<pair<int,int>> circleWorkload(int n, int h, int r, mt19937 &rng)
+{
+    vector<pair<int,int>> v;
+    const double PI = acos(-1.0);
+    for(int i=0;i<h;i++)
+    {
+        double a = 2*PI*i/h;
+        v.push_back(make_pair((int)lround(r*cos(a)), (int)lround(r*sin(a))));
+    }
+    // Largest circle that fits inside the regular h-gon, minus a margin for rounding
+    double rin = r*cos(PI/h) - 2;
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    while((int)v.size() < n)
+    {
+        double a = 2*PI*unit(rng);
+        double d = rin*sqrt(unit(rng));
+        v.push_back(make_pair((int)(d*cos(a)), (int)(d*sin(a))));
+    }
+    shuffle(v.begin(), v.end(), rng);
+    return v;
+}
+
+//Utility function to time one engine run in milliseconds. The engines report
+//their hulls on cout, that is switched off so it stays out of the timings.
+template<typename Run>
+double timeRun(Run run)
+{
+    streambuf *out = cout.rdbuf(NULL);
+    auto start = chrono::steady_clock::now();
+    run();
+    auto end = chrono::steady_clock::now();
+    cout.rdbuf(out);
+    return chrono::duration<double, milli>(end - start).count();
+}
+
+//Utility function to print one CSV row, removed is the fraction of points
+//dropped by the Akl-Toussaint prefilter
+void report(string engine, int n, int h, double ms, double removed)
+{
+    cout << engine << "," << n << "," << h << "," << ms << "," << ms*1e6/n << "," << removed << endl;
+}
+
+//Double workloads of the predicates mode
+const char *doubleWorkloads[] = {"uniform", "near-collinear", "subnormal"};
+
+//Utility function to generate n double points of a workload above: uniform in
+//the unit square, or on the line y = x/3 with only the last bits perturbed,
+//which is where the error bound of orient2d cannot decide the sign. The
+//subnormal one also puts one point in 64 at x = 0, where the perturbed y are
+//subnormal and the products of the predicates underflow.
+vector<pair<double,double>> doubleWorkload(int n, int workload, mt19937 &rng)
+{
+    vector<pair<double,double>> v(n);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    for(int i=0;i<n;i++)
+    {
+        double x = unit(rng);
+        if(workload == 2 && rng()%64 == 0)
+            x = 0;
+        double y = workload == 0 ? unit(rng) : x/3;
+        for(int k=rng()%4;k>0;k--)
+            y = nextafter(y, (rng() & 1) ? 1.0 : 0.0);
+        v[i] = make_pair(x, y);
+    }
+    return v;
+}
+
+//Times orient2d against the plain double determinant on consecutive triples
+//of v, and the monotone chain on v. adaptive and exact are the percentages of
+//the timed orient2d calls that went past the error bound and that needed the
+//full expansion. agree is 1 if the Jarvis march, QuickHull and the
+//KirkPatrickSeidel modes give the same hull as the monotone chain on v, and
+//orient2d gets a triple whose
+//products underflow right.
+void predicateBenchmark(int n, int workload, mt19937 &rng)
+{
+    vector<pair<double,double>> v = doubleWorkload(n, workload, rng);
+    int sink = 0;
+    auto naive = [&]()
+    {
+        for(int i=0;i+2<n;i++)
+        {
+            double det = (v[i+1].first-v[i].first)*(v[i+2].second-v[i].second) - (v[i+1].second-v[i].second)*(v[i+2].first-v[i].first);
+            sink += (det > 0) - (det < 0);
+        }
+    };
+    auto filtered = [&]()
+    {
+        for(int i=0;i+2<n;i++)
+            sink += orient2d(v[i].first, v[i].second, v[i+1].first, v[i+1].second, v[i+2].first, v[i+2].second);
+    };
+    // Best of a few runs, the loops are short enough for noise to matter
+    double naiveMs = 1e18, filteredMs = 1e18;
+    for(int rep=0;rep<5;rep++)
+    {
+        naiveMs = min(naiveMs, timeRun(naive));
+        predicateStats.adaptive = 0;
+        predicateStats.exact = 0;
+        filteredMs = min(filteredMs, timeRun(filtered));
+    }
+    double adaptive = 100.0*predicateStats.adaptive/n, exact = 100.0*predicateStats.exact/n;
+    GrahamScan gs(v);
+    MemorySink<double> ref, out;
+    gs.sink = &ref;
+    double hullMs = timeRun([&]() { gs.convexHullMonotone(); });
+    // (0.2, 0.0666) is right of the segment from (0, 2^-1074) down to (0, 0)
+    bool agree = orient2d(0.0, 0x1p-1074, 0.2, 0.0666, 0.0, 0.0) == -1;
+    JarvisMarch jm(v);
+    jm.sink = &out;
+    jm.convexHull();
+    agree &= out.vertices == ref.vertices;
+    QuickHull qh(v);
+    qh.sink = &out;
+    qh.convexHull();
+    agree &= out.vertices == ref.vertices;
+    KirkPatrickSeidel ks(v);
+    ks.sink = &out;
+    ks.kps();
+    agree &= out.vertices == ref.vertices;
+    ks.kpsInPlace();
+    agree &= out.vertices == ref.vertices;
+    cout << doubleWorkloads[workload] << "," << n << "," << naiveMs*1e6/n << "," << filteredMs*1e6/n << ","
+         << adaptive << "," << exact << "," << hullMs << "," << agree << (sink == 42 ? " " : "") << endl;
+}
+
+//Workload generators of the suite. Every one is seeded, so a run can be
+//repeated exactly, and keeps the coordinates below 2^29 in absolute value so
+//the int predicates of every engine stay exact.
+typedef vector<pair<int,int>> Points;
+const int R = 1 << 29;
+
+Points uniformSquare(int n, mt19937_64 &rng)
+{
+    uniform_int_distribution<int> c(-R, R);
+    Points v(n);
+    for(int i=0;i<n;i++)
+        v[i] = make_pair(c(rng), c(rng));
+    return v;
+}
+
+Points uniformDisk(int n, mt19937_64 &rng)
+{
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    Points v(n);
+    for(int i=0;i<n;i++)
+    {
+        double a = 2*acos(-1.0)*unit(rng), d = R*sqrt(unit(rng));
+        v[i] = make_pair((int)(d*cos(a)), (int)(d*sin(a)));
+    }
+    return v;
+}
+
+//Every point on the circle, h is close to n until the rounding to the grid
+//puts some of them inside
+Points onCircle(int n, mt19937_64 &rng)
+{
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    Points v(n);
+    for(int i=0;i<n;i++)
+    {
+        double a = 2*acos(-1.0)*unit(rng);
+        v[i] = make_pair((int)lround(R*cos(a)), (int)lround(R*sin(a)));
+    }
+    return v;
+}
+
+Points gaussian(int n, mt19937_64 &rng)
+{
+    normal_distribution<double> c(0.0, R/8.0);
+    Points v(n);
+    for(int i=0;i<n;i++)
+        v[i] = make_pair((int)max(-1.0*R, min(1.0*R, c(rng))), (int)max(-1.0*R, min(1.0*R, c(rng))));
+    return v;
+}
+
+//Points within a few units of the line y = x/3, the orientation tests are
+//decided by the last bits of the cross products
+Points nearCollinear(int n, mt19937_64 &rng)
+{
+    uniform_int_distribution<int> c(-R, R), off(-2, 2);
+    Points v(n);
+    for(int i=0;i<n;i++)
+    {
+        int x = c(rng);
+        v[i] = make_pair(x, x/3 + off(rng));
+    }
+    return v;
+}
+
+//Every point repeated about 100 times, drawn from n/100 points in a disk
+Points duplicateHeavy(int n, mt19937_64 &rng)
+{
+    Points distinct = uniformDisk(max(1, n/100), rng);
+    uniform_int_distribution<int> pick(0, distinct.size() - 1);
+    Points v(n);
+    for(int i=0;i<n;i++)
+        v[i] = distinct[pick(rng)];
+    return v;
+}
+
+//Cost of one engine run: time, operator new calls and peak resident set in KB.
+//The peak is reset through /proc/self/clear_refs before the run, so it is the
+//peak of this run on top of what was already resident, input included.
+struct Measurement
+{
+    double ms;
+    long long allocs;
+    long long peakKb;
+};
+
+long long peakRssKb()
+{
+    ifstream status("/proc/self/status");
+    string line;
+    while(getline(status, line))
+        if(line.compare(0, 6, "VmHWM:") == 0)
+            return atoll(line.c_str() + 6);
+    return -1;
+}
+
+template<typename Run>
+Measurement measure(Run run)
+{
+    ofstream("/proc/self/clear_refs") << "5";
+    long long before = allocations;
+    double ms = timeRun(run);
+    return Measurement{ms, allocations - before, peakRssKb()};
+}
+
+//Measures an engine run with the hull going to memory, so no file is written
+template<typename E, typename Run>
+Measurement quiet(E &engine, Run run)
+{
+    MemorySink<int> out;
+    engine.sink = &out;
+    return measure(run);
+}
+
+//Engines of the suite. Each one is built outside the measured run, so only the
+//hull itself is measured, like the rows of the main benchmark.
+struct Engine
+{
+    string name;
+    function<Measurement(const Points &)> run;
+};
+
+vector<Engine> suiteEngines()
+{
+    int threads = thread::hardware_concurrency();
+    return {
+        {"Graham", [](const Points &v) { GrahamScan e(v); return quiet(e, [&]() { e.convexHull(); }); }},
+        {"MonotoneChain", [](const Points &v) { GrahamScan e(v); return quiet(e, [&]() { e.convexHullMonotone(); }); }},
+        {"Jarvis", [](const Points &v) { JarvisMarch e(v); return quiet(e, [&]() { e.convexHull(); }); }},
+        {"Chan", [](const Points &v) { ChanHull e(v); return quiet(e, [&]() { e.convexHull(); }); }},
+        {"QuickHull", [](const Points &v) { QuickHull e(v); return quiet(e, [&]() { e.convexHull(); }); }},
+        {"QuickHull-parallel", [=](const Points &v) { QuickHull e(v); return quiet(e, [&]() { e.convexHullParallel(threads); }); }},
+        {"KPS", [](const Points &v) { KirkPatrickSeidel e(v); return quiet(e, [&]() { e.kps(); }); }},
+        {"KPS-inplace", [](const Points &v) { KirkPatrickSeidel e(v); return quiet(e, [&]() { e.kpsInPlace(); }); }},
+        {"KPS-parallel", [=](const Points &v) { KirkPatrickSeidel e(v); return quiet(e, [&]() { e.kpsParallel(threads); }); }},
+        {"Incremental", [](const Points &v) { IncrementalHull<int> e; return quiet(e, [&]() { for(auto &p : v) e.insert(p); e.convexHull(); }); }},
+        {"ParallelHull", [=](const Points &v) { ParallelHull e(v, threads); return quiet(e, [&]() { e.convexHull(); }); }},
+    };
+}
+
+//./benchmark suite [maxn] [csv|json] [seed] : every engine on every workload,
+//n going up by 10 from 1e3 to maxn (default 1e6, at most 1e8). Jarvis march is
+//skipped where n*h is above 1e9. h is counted once per workload with the
+//monotone chain.
+void suite(long long maxn, bool json, unsigned long long seed)
+{
+    vector<pair<string, function<Points(int, mt19937_64 &)>>> workloads = {
+        {"uniform-square", uniformSquare}, {"uniform-disk", uniformDisk}, {"circle", onCircle},
+        {"gaussian", gaussian}, {"near-collinear", nearCollinear}, {"duplicate-heavy", duplicateHeavy},
+    };
+    vector<Engine> engines = suiteEngines();
+    bool first = true;
+    if(json)
+        cout << "[" << endl;
+    else
+        cout << "workload,engine,n,h,ms,ns_per_point,allocations,peak_rss_kb" << endl;
+    for(long long n = 1000; n <= min(maxn, 100000000LL); n *= 10)
+        for(int w = 0; w < workloads.size(); w++)
+        {
+            mt19937_64 rng(seed + w);
+            Points v = workloads[w].second(n, rng);
+            int h;
+            {
+                PointSet<int> ps(v);
+                vector<int> chain(n + 1);
+                h = monotoneChain(ps, 0, n, &chain[0]);
+            }
+            for(int e = 0; e < engines.size(); e++)
+            {
+                if(engines[e].name == "Jarvis" && (double)n * h > 1e9)
+                    continue;
+                Measurement m = engines[e].run(v);
+                if(json)
+                    cout << (first ? "" : ",\n") << "  {\"workload\": \"" << workloads[w].first << "\", \"engine\": \"" << engines[e].name
+                         << "\", \"n\": " << n << ", \"h\": " << h << ", \"ms\": " << m.ms << ", \"ns_per_point\": " << m.ms*1e6/n
+                         << ", \"allocations\": " << m.allocs << ", \"peak_rss_kb\": " << m.peakKb << "}" << flush;
+                else
+                    cout << workloads[w].first << "," << engines[e].name << "," << n << "," << h << "," << m.ms << ","
+                         << m.ms*1e6/n << "," << m.allocs << "," << m.peakKb << endl;
+                first = false;
+            }
+        }
+    if(json)
+        cout << endl << "]" << endl;
+}
+
+//./benchmark dynamic [n] [ops] [seed] : n points in a disk, then streams of ops
+//updates of which a given fraction are deletions of a random live point, with
+//the hull asked for after every update. DynamicHull is updated in place, the
+//rebuild row runs the monotone chain on the live points from scratch, over the
+//first 1000 updates at most. us_per_update includes the hull query.
+void dynamicBenchmark(int n, int ops, unsigned long long seed)
+{
+    cout << "structure,n,updates,deletions,us_per_update,hull" << endl;
+    for(double deletions : {0.1, 0.5, 0.9})
+    {
+        mt19937_64 rng(seed);
+        Points live = uniformDisk(n, rng);
+        Points fresh = uniformDisk(ops, rng);
+        // The stream is drawn up front so both structures see the same one:
+        // a point of fresh to add, or the slot of live to delete
+        vector<long long> stream(ops);
+        bernoulli_distribution erase(deletions);
+        for(int i=0, size=n;i<ops;i++)
+        {
+            stream[i] = size > 0 && erase(rng) ? -1 - (long long)(rng() % size) : i;
+            size += stream[i] < 0 ? -1 : 1;
+        }
+        auto apply = [&](Points &pts, long long op, function<void(pair<int,int>)> add, function<void(pair<int,int>)> remove)
+        {
+            if(op >= 0)
+            {
+                pts.push_back(fresh[op]);
+                add(fresh[op]);
+                return;
+            }
+            int slot = -1 - op;
+            remove(pts[slot]);
+            pts[slot] = pts.back();
+            pts.pop_back();
+        };
+
+        Points pts = live;
+        DynamicHull<int> dh(pts);
+        MemorySink<int> out;
+        dh.sink = &out;
+        double ms = timeRun([&]()
+        {
+            for(int i=0;i<ops;i++)
+            {
+                apply(pts, stream[i], [&](pair<int,int> p) { dh.insert(p); }, [&](pair<int,int> p) { dh.erase(p); });
+                dh.convexHull();
+            }
+        });
+        cout << "DynamicHull," << n << "," << ops << "," << deletions << "," << ms*1e3/ops << "," << dh.snapshot().size() << endl;
+
+        pts = live;
+        int rebuilds = min(ops, 1000);
+        auto none = [](pair<int,int>) {};
+        ms = timeRun([&]()
+        {
+            for(int i=0;i<rebuilds;i++)
+            {
+                apply(pts, stream[i], none, none);
+                GrahamScan gs(pts);
+                gs.sink = &out;
+                gs.convexHullMonotone();
+            }
+        });
+        cout << "rebuild," << n << "," << rebuilds << "," << deletions << "," << ms*1e3/rebuilds << "," << out.vertices.size() << endl;
+    }
+}
+
+//Utility function to print the latency percentiles of one structure, lat is
+//in ns per update and gets sorted
+void latencyRow(string structure, int W, vector<double> &lat)
+{
+    sort(lat.begin(), lat.end());
+    auto at = [&](double q) { return lat[min(lat.size() - 1, (size_t)(q*lat.size()))]/1e3; };
+    cout << structure << "," << W << "," << lat.size() << "," << at(0.5) << "," << at(0.9) << ","
+         << at(0.99) << "," << at(0.999) << "," << lat.back()/1e3 << endl;
+}
+
+//./benchmark window [n] [seed] : a stream of n points in a disk through windows
+//of the last W = 100, 1000, ... points, with the hull asked for after every
+//point. SlidingHull is updated in place, the rebuild rows run the monotone
+//chain over the window, for the first 2000 full windows at most. Latencies are
+//in us per update.
+void windowBenchmark(int n, unsigned long long seed)
+{
+    cout << "structure,W,updates,p50_us,p90_us,p99_us,p999_us,max_us" << endl;
+    mt19937_64 rng(seed);
+    Points stream = uniformDisk(n, rng);
+    MemorySink<int> out;
+    auto now = []() { return chrono::steady_clock::now(); };
+    for(int W = 100; W < n; W *= 10)
+    {
+        SlidingHull<int> sh(W);
+        sh.sink = &out;
+        vector<double> lat;
+        lat.reserve(n);
+        for(int i=0;i<n;i++)
+        {
+            auto start = now();
+            sh.push(stream[i]);
+            sh.convexHull();
+            lat.push_back(chrono::duration<double, nano>(now() - start).count());
+        }
+        latencyRow("SlidingHull", W, lat);
+
+        lat.clear();
+        for(int i=W;i<n && i<W+2000;i++)
+        {
+            auto start = now();
+            GrahamScan gs(Points(stream.begin() + i - W + 1, stream.begin() + i + 1));
+            gs.sink = &out;
+            gs.convexHullMonotone();
+            lat.push_back(chrono::duration<double, nano>(now() - start).count());
+        }
+        latencyRow("rebuild", W, lat);
+    }
+}
+
+//./benchmark batch [sets] [seed] : sets polygons of 10 to 500 points in a disk
+//each, hulled one GrahamScan per set and by BatchHull on one thread and on
+//all of them. BatchHull runs twice, the second run reuses the buffers and is
+//the one timed.
+void batchBenchmark(int sets, unsigned long long seed)
+{
+    cout << "structure,threads,sets,points,ms,hulls_per_s,allocations" << endl;
+    mt19937_64 rng(seed);
+    vector<int> coords, offsets(1, 0);
+    uniform_int_distribution<int> size(10, 500);
+    for(int s=0;s<sets;s++)
+    {
+        Points v = uniformDisk(size(rng), rng);
+        for(int i=0;i<v.size();i++)
+        {
+            coords.push_back(v[i].first);
+            coords.push_back(v[i].second);
+        }
+        offsets.push_back(offsets.back() + v.size());
+    }
+    auto row = [&](string structure, int threads, Measurement m)
+    {
+        cout << structure << "," << threads << "," << sets << "," << offsets.back() << "," << m.ms << ","
+             << sets/(m.ms/1e3) << "," << m.allocs << endl;
+    };
+
+    MemorySink<int> out;
+    row("GrahamScan", 1, measure([&]()
+    {
+        for(int s=0;s<sets;s++)
+        {
+            Points v(offsets[s+1] - offsets[s]);
+            for(int i=0;i<v.size();i++)
+                v[i] = make_pair(coords[2*(offsets[s]+i)], coords[2*(offsets[s]+i)+1]);
+            GrahamScan gs(v);
+            gs.sink = &out;
+            gs.convexHullMonotone();
+        }
+    }));
+
+    for(int threads : {1, (int)thread::hardware_concurrency()})
+    {
+        BatchHull<int> bh(threads);
+        vector<int> hull, hullOffsets;
+        bh.run(coords.data(), offsets.data(), sets, hull, hullOffsets);
+        row("BatchHull", threads, measure([&]() { bh.run(coords.data(), offsets.data(), sets, hull, hullOffsets); }));
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if(argc > 1 && string(argv[1]) == "suite")
+    {
+        suite(argc > 2 ? atoll(argv[2]) : 1000000, argc > 3 && string(argv[3]) == "json", argc > 4 ? strtoull(argv[4], NULL, 10) : 12345);
+        return 0;
+    }
+    if(argc > 1 && string(argv[1]) == "window")
+    {
+        windowBenchmark(argc > 2 ? atoi(argv[2]) : 1000000, argc > 3 ? strtoull(argv[3], NULL, 10) : 12345);
+        return 0;
+    }
+    if(argc > 1 && string(argv[1]) == "batch")
+    {
+        batchBenchmark(argc > 2 ? atoi(argv[2]) : 1000000, argc > 3 ? strtoull(argv[3], NULL, 10) : 12345);
+        return 0;
+    }
+    if(argc > 1 && string(argv[1]) == "dynamic")
+    {
+        dynamicBenchmark(argc > 2 ? atoi(argv[2]) : 100000, argc > 3 ? atoi(argv[3]) : 100000, argc > 4 ? strtoull(argv[4], NULL, 10) : 12345);
+        return 0;
+    }
+
+    int n = argc > 1 ? atoi(argv[1]) : 100000;
+    mt19937 rng(12345);
+
+    // ./benchmark n predicates : cost of the robust floating point predicates
+    if(argc > 2 && string(argv[2]) == "predicates")
+    {
+        cout << "workload,n,naive_ns,filtered_ns,adaptive,exact,hull_ms,agree" << endl;
+        for(int w = 0; w < 3; w++)
+            predicateBenchmark(n, w, rng);
+        return 0;
+    }
+
+    // The predicates work in the wide type of the coordinates, so the
+    // circle can be as large as the suite workloads. The hulls go to a
+    // MemorySink, no file is written inside the timed runs.
+    int r = R;
+    MemorySink<int> out;
+
+    cout << "engine,n,h,ms,ns_per_point,removed" << endl;
+    for(int h = 4; h <= 1024; h *= 2)
+    {
+        vector<pair<int,int>> v = circleWorkload(n, h, r, rng);
+        for(int det = 0; det < 2; det++)
+        {
+            KirkPatrickSeidel ks(v, det == 1);
+            ks.sink = &out;
+            double ms = timeRun([&]() { ks.kps(); });
+            report(det ? "KPS-mom" : "KPS-introselect", n, h, ms, 0);
+        }
+
+        // The first call sizes the buffers, the second one is timed
+        KirkPatrickSeidel ki(v);
+        ki.sink = &out;
+        timeRun([&]() { ki.kpsInPlace(); });
+        double ms = timeRun([&]() { ki.kpsInPlace(); });
+        report("KPS-inplace", n, h, ms, 0);
+
+        KirkPatrickSeidel kp(v);
+        kp.sink = &out;
+        ms = timeRun([&]() { kp.kpsParallel(thread::hardware_concurrency()); });
+        report("KPS-parallel", n, h, ms, 0);
+
+        ParallelHull ph(v);
+        ph.sink = &out;
+        ms = timeRun([&]() { ph.convexHull(); });
+        report("ParallelHull", n, h, ms, 0);
+
+        QuickHull qh(v);
+        qh.sink = &out;
+        ms = timeRun([&]() { qh.convexHull(); });
+        report("QuickHull", n, h, ms, 0);
+        ms = timeRun([&]() { qh.convexHullParallel(thread::hardware_concurrency()); });
+        report("QuickHull-parallel", n, h, ms, 0);
+
+        for(int filter = 0; filter < 2; filter++)
+        {
+            ChanHull ch(v);
+            ch.sink = &out;
+            double ms = timeRun([&]() { ch.convexHull(filter == 1); });
+            report(filter ? "Chan+prefilter" : "Chan", n, h, ms, ch.reduction);
+
+            GrahamScan gs(v);
+            gs.sink = &out;
+            ms = timeRun([&]() { gs.convexHullMonotone(filter == 1); });
+            report(filter ? "MonotoneChain+prefilter" : "MonotoneChain", n, h, ms, gs.reduction);
+        }
+    }
+    return 0;
+}
@@ -1,10 +1,99 @@
 #include<iostream>
 #include<vector>
 #include "convexhull.h"
+#include "PointLoader.h"
+#include "ShardedHull.h"
 
 using namespace std;
 
-int main() {
+//Runs the named engine on ps, the hull goes to testpoints.txt and cout
+template<typename T>
+int runEngine(PointSet<T> ps, string engine)
+{
+	int threads = thread::hardware_concurrency();
+	if (engine == "graham")
+		GrahamScan<T>(move(ps)).convexHull();
+	else if (engine == "monotone")
+		GrahamScan<T>(move(ps)).convexHullMonotone();
+	else if (engine == "jarvis")
+		JarvisMarch<T>(move(ps)).convexHull();
+	else if (engine == "chan")
+		ChanHull<T>(move(ps)).convexHull();
+	else if (engine == "quickhull")
+		QuickHull<T>(move(ps)).convexHull();
+	else if (engine == "quickhull-parallel")
+		QuickHull<T>(move(ps)).convexHullParallel(threads);
+	else if (engine == "kps")
+		KirkPatrickSeidel<T>(move(ps)).kps();
+	else if (engine == "kps-inplace")
+		KirkPatrickSeidel<T>(move(ps)).kpsInPlace();
+	else if (engine == "kps-parallel")
+		KirkPatrickSeidel<T>(move(ps)).kpsParallel(threads);
+	else if (engine == "parallel")
+		ParallelHull<T>(move(ps), threads).convexHull();
+	else if (engine == "sharded")
+		ShardedHull<T>(move(ps), threads).convexHull();
+	else
+	{
+		cerr << "unknown engine " << engine << endl;
+		return 1;
+	}
+	return 0;
+}
+
+//Loads path as packed binary coordinates or as text, one "x y" line per point.
+//external streams a binary file through ExternalHull instead of loading it,
+//sharded lets the workers of ShardedHull stream their parts of it.
+template<typename T>
+int runFile(string path, string engine, bool binary)
+{
+	if (engine == "external")
+	{
+		if (!binary)
+		{
+			cerr << "external needs a binary point file" << endl;
+			return 1;
+		}
+		ExternalHull<T>(path).convexHull();
+		return 0;
+	}
+	if (engine == "sharded" && binary)
+	{
+		ShardedHull<T>(path, thread::hardware_concurrency()).convexHull();
+		return 0;
+	}
+	MappedFile file(path);
+	return runEngine<T>(binary ? loadBinary<T>(file) : loadText<T>(file), engine);
+}
+
+//./caller path engine [text|binary] [int32|int64|double]
+//engine is one of graham, monotone, jarvis, chan, quickhull, quickhull-parallel,
+//kps, kps-inplace, kps-parallel, parallel, sharded or, for binary files,
+//external.
+//Without arguments the points below are used.
+int main(int argc, char *argv[]) {
+	if (argc > 2)
+	{
+		bool binary = argc > 3 && string(argv[3]) == "binary";
+		string type = argc > 4 ? argv[4] : "int32";
+		try
+		{
+			if (type == "int32")
+				return runFile<int>(argv[1], argv[2], binary);
+			if (type == "int64")
+				return runFile<long long>(argv[1], argv[2], binary);
+			if (type == "double")
+				return runFile<double>(argv[1], argv[2], binary);
+		}
+		catch (exception &e)
+		{
+			cerr << e.what() << endl;
+			return 1;
+		}
+		cerr << "unknown coordinate type " << type << endl;
+		return 1;
+	}
+
 	vector<pair<int, int> >v;
 
     // v.push_back(make_pair());
@@ -65,7 +154,51 @@ int main() {
 
 
 	KirkPatrickSeidel ks(v);
+	// The hull goes to testpoints.txt and cout unless a sink is set, e.g.
+	// MemorySink<int> out; ks.sink = &out;
+	// or TextSink<int>("hull.txt"), BinarySink<int>("hull.bin")
 	ks.kps();
+	// Pass true to drop the points inside the Akl-Toussaint octagon first,
+	// ks.reduction is then the fraction of points removed
+	// ks.kps(true);
+	// Or on a pool of 8 threads
+	// ks.kpsParallel(8);
+	// Or on preallocated buffers, with no allocations in the recursion
+	// ks.kpsInPlace();
+
+	// ChanHull ch(v);
+	// ch.convexHull();
+
+	// Or cut into x-slabs, one per thread, hulled in parallel and merged
+	// ParallelHull ph(v, 8);
+	// ph.convexHull();
+
+	// Or one point at a time, the hull is kept after every insert
+	// IncrementalHull<int> ih;
+	// for (auto &p : v) ih.insert(p);
+	// ih.convexHull();
+	// Or with deletions as well
+	// DynamicHull<int> dh(v);
+	// dh.erase(v[0]);
+	// dh.convexHull();
+	// Or over the last 1000 points of a stream, or the last 60 seconds
+	// SlidingHull<int> sw(1000, 60);
+	// sw.push(v[0], time);
+	// sw.convexHull();
+	// Or many small sets at once, set s being the points offsets[s] to
+	// offsets[s+1]-1 of coords, its hull the points hullOffsets[s] to
+	// hullOffsets[s+1]-1 of hull
+	// BatchHull<int> bh;
+	// bh.run(coords.data(), offsets.data(), sets, hull, hullOffsets);
+
+	// Or in 8 worker processes, one shard each
+	// ShardedHull<int> sh(v, 8);
+	// sh.convexHull();
+
+	// QuickHull qh(v);
+	// qh.convexHull();
+	// Or with the subproblems as tasks on a pool of 8 threads
+	// qh.convexHullParallel(8);
 
 	return 0;
 }
\ No newline at end of file
@@ -0,0 +1,306 @@
+#pragma once
+#include "UtilFunction.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//Loaders that read point files straight into the PointSet the engines are
+//built from. The engines take the PointSet by value, so
+//	KirkPatrickSeidel ks(loadBinary<int>(MappedFile("points.bin")));
+//moves it in and the coordinates are only written once, by the loader.
+
+//Read only memory map of a whole file, unmapped when destroyed
+class MappedFile
+{
+public:
+	MappedFile(string path) : fd(-1), base(NULL), length(0)
+	{
+		fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			throw runtime_error("cannot open " + path);
+		struct stat st;
+		if (fstat(fd, &st) != 0)
+		{
+			close(fd);
+			throw runtime_error("cannot stat " + path);
+		}
+		length = st.st_size;
+		if (length > 0)
+		{
+			base = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (base == MAP_FAILED)
+			{
+				close(fd);
+				throw runtime_error("cannot map " + path);
+			}
+			// The loaders read the file front to back
+			madvise(base, length, MADV_SEQUENTIAL);
+		}
+	}
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	~MappedFile()
+	{
+		if (base)
+			munmap(base, length);
+		close(fd);
+	}
+
+	const char *data() const { return (const char *)base; }
+	size_t size() const { return length; }
+
+private:
+	int fd;
+	void *base;
+	size_t length;
+};
+
+//Packed binary coordinates, x0 y0 x1 y1 ... each one a C (int32_t, int64_t or
+//double) in the byte order of the machine, without a header. The threads
+//split the points between them, each one copies its part of the mapping into
+//the coordinate arrays.
+template<typename T, typename C = T>
+PointSet<T> loadBinary(const MappedFile &file, int threads = thread::hardware_concurrency())
+{
+	if (file.size() % (2 * sizeof(C)) != 0)
+		throw runtime_error("binary point file is not a whole number of coordinate pairs");
+	long long n = file.size() / (2 * sizeof(C));
+	if (n > INT_MAX)
+		throw runtime_error("too many points for int slots");
+	PointSet<T> ps;
+	ps.x.resize(n);
+	ps.y.resize(n);
+	ps.idx.resize(n);
+	const C *c = (const C *)file.data();
+	TaskPool pool(threads);
+	pool.forChunks(n, pool.chunks(n, 1 << 16), [&](int part, int lo, int hi)
+	{
+		for (int i = lo; i < hi; i++)
+		{
+			ps.x[i] = (T)c[2*(long long)i];
+			ps.y[i] = (T)c[2*(long long)i+1];
+			ps.idx[i] = i;
+		}
+	});
+	return ps;
+}
+
+//Text coordinates, x and y of a point on one line, separated by spaces, tabs
+//or a comma. The mapping is cut into one piece per thread at line breaks and
+//every piece is parsed with from_chars into its own arrays, which are then
+//copied into place in file order. A line that is not two numbers is an error.
+template<typename T>
+PointSet<T> loadText(const MappedFile &file, int threads = thread::hardware_concurrency())
+{
+	const char *text = file.data();
+	size_t size = file.size();
+	TaskPool pool(threads);
+	int parts = max(1, (int)min<size_t>(4 * pool.size(), size / (1 << 16)));
+
+	// Piece k is [cut[k], cut[k+1]), every cut but the ends is right after a '\n'
+	vector<size_t> cut(parts + 1, size);
+	cut[0] = 0;
+	for (int k = 1; k < parts; k++)
+	{
+		size_t at = max(cut[k-1], size / parts * k);
+		const char *nl = (const char *)memchr(text + at, '\n', size - at);
+		cut[k] = nl ? nl - text + 1 : size;
+	}
+
+	vector<vector<T> > xs(parts), ys(parts);
+	vector<long long> badLine(parts, -1);
+	pool.forChunks(parts, parts, [&](int c, int lo, int hi)
+	{
+		for (int k = lo; k < hi; k++)
+		{
+			const char *p = text + cut[k], *end = text + cut[k+1];
+			auto blank = [&]() { while (p < end && (*p == ' ' || *p == '\t' || *p == '\r' || *p == ',')) p++; };
+			while (p < end)
+			{
+				blank();
+				if (p < end && *p == '\n')
+				{
+					p++;
+					continue;
+				}
+				if (p == end)
+					break;
+				T x, y;
+				auto rx = from_chars(p, end, x);
+				p = rx.ptr;
+				blank();
+				auto ry = from_chars(p, end, y);
+				p = ry.ptr;
+				blank();
+				if (rx.ec != errc() || ry.ec != errc() || (p < end && *p != '\n'))
+				{
+					badLine[k] = p - text;
+					break;
+				}
+				xs[k].push_back(x);
+				ys[k].push_back(y);
+			}
+		}
+	});
+	for (int k = 0; k < parts; k++)
+		if (badLine[k] >= 0)
+			throw runtime_error("bad point line at byte " + to_string(badLine[k]));
+
+	vector<long long> start(parts + 1, 0);
+	for (int k = 0; k < parts; k++)
+		start[k+1] = start[k] + xs[k].size();
+	if (start[parts] > INT_MAX)
+		throw runtime_error("too many points for int slots");
+	PointSet<T> ps;
+	ps.x.resize(start[parts]);
+	ps.y.resize(start[parts]);
+	ps.idx.resize(start[parts]);
+	pool.forChunks(parts, parts, [&](int c, int lo, int hi)
+	{
+		for (int k = lo; k < hi; k++)
+			for (int i = 0; i < xs[k].size(); i++)
+			{
+				ps.x[start[k] + i] = xs[k][i];
+				ps.y[start[k] + i] = ys[k][i];
+				ps.idx[start[k] + i] = start[k] + i;
+			}
+	});
+	return ps;
+}
+
+//Hull of a packed binary point file in the format of loadBinary() that does
+//not have to fit in memory. The file is read in chunks of chunkPoints points,
+//each chunk is reduced to the hull of its points and of the hull so far, and
+//the next chunk is read by another thread in the meantime. At most two raw
+//chunks, one chunk as a PointSet and the hull are held at once.
+template<typename T, typename C = T>
+class ExternalHull
+{
+public:
+
+	//Where the hull goes, NULL for the default output of writeHull()
+	HullSink<T> *sink;
+	//Number of points read by the last convexHull()
+	long long points;
+	//Only the points first to first+count-1 of the file are read, count -1
+	//reads up to the end
+	long long first, count;
+
+	ExternalHull(string path, int chunkPoints = 1 << 22) : path(path), chunkPoints(max(chunkPoints, 1))
+	{
+		sink=NULL;
+		points=0;
+		first=0;
+		count=-1;
+	}
+
+	void convexHull()
+	{
+		int fd = open(path.c_str(), O_RDONLY);
+		if (fd < 0)
+			throw runtime_error("cannot open " + path);
+		struct stat st;
+		if (fstat(fd, &st) != 0)
+		{
+			close(fd);
+			throw runtime_error("cannot stat " + path);
+		}
+		if (st.st_size % (2 * sizeof(C)) != 0)
+		{
+			close(fd);
+			throw runtime_error("binary point file is not a whole number of coordinate pairs");
+		}
+		posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+		long long n = st.st_size / (2 * sizeof(C));
+		if (first < 0 || first > n || (count >= 0 && first + count > n))
+		{
+			close(fd);
+			throw runtime_error("point range out of the file");
+		}
+		n = count >= 0 ? count : n - first;
+		long long chunks = (n + chunkPoints - 1) / chunkPoints;
+
+		vector<C> raw[2];
+		vector<pair<T,T> > hull;
+		PointSet<T> ps;
+		vector<int> chain;
+		future<void> next;
+		auto readChunk = [&](long long k)
+		{
+			return async(launch::async, [&, k]() { fetch(fd, k, min<long long>(chunkPoints, n - k * chunkPoints), raw[k % 2]); });
+		};
+		try
+		{
+			if (chunks > 0)
+				next = readChunk(0);
+			for (long long k = 0; k < chunks; k++)
+			{
+				next.get();
+				if (k + 1 < chunks)
+					next = readChunk(k + 1);
+
+				// The chunk and the hull so far, reduced to their hull
+				const vector<C> &c = raw[k % 2];
+				int m = c.size() / 2;
+				ps.x.resize(m + hull.size());
+				ps.y.resize(m + hull.size());
+				ps.idx.resize(m + hull.size());
+				for (int i = 0; i < m; i++)
+				{
+					ps.x[i] = (T)c[2*(long long)i];
+					ps.y[i] = (T)c[2*(long long)i+1];
+				}
+				for (int i = 0; i < hull.size(); i++)
+				{
+					ps.x[m + i] = hull[i].first;
+					ps.y[m + i] = hull[i].second;
+				}
+				for (int i = 0; i < ps.size(); i++)
+					ps.idx[i] = i;
+				aklToussaint(ps);
+				chain.resize(ps.size() + 1);
+				int h = monotoneChain(ps, 0, ps.size(), &chain[0]);
+				hull.resize(h);
+				for (int i = 0; i < h; i++)
+					hull[i] = ps.point(chain[i]);
+			}
+		}
+		catch (...)
+		{
+			if (next.valid())
+				next.wait();
+			close(fd);
+			throw;
+		}
+		close(fd);
+		points = n;
+		writeHull(hull, sink);
+	}
+
+	~ExternalHull(){}
+
+private:
+
+	string path;
+	int chunkPoints;
+
+	// Reads the count points of chunk k into buf and drops them from the page
+	// cache, which would otherwise grow with the file
+	void fetch(int fd, long long k, long long count, vector<C> &buf)
+	{
+		buf.resize(2 * count);
+		size_t bytes = buf.size() * sizeof(C), done = 0;
+		off_t at = (first + k * chunkPoints) * 2 * sizeof(C);
+		while (done < bytes)
+		{
+			ssize_t got = pread(fd, (char *)buf.data() + done, bytes - done, at + done);
+			if (got <= 0)
+				throw runtime_error("cannot read " + path);
+			done += got;
+		}
+		posix_fadvise(fd, at, bytes, POSIX_FADV_DONTNEED);
+	}
+};
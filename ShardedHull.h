@@ -0,0 +1,233 @@
+#pragma once
+#include "convexhull.h"
+#include "PointLoader.h"
+#include <sys/wait.h>
+
+//Hull over several worker processes on one machine. The points are cut into
+//one contiguous shard per worker, every worker is a fork()ed child that hulls
+//its shard and sends the hull back through a pipe, and the parent merges the
+//partial hulls. A worker that crashes or fails makes convexHull() throw
+//instead of taking the parent down with it.
+//	ShardedHull<int> sh(points, 8);
+//hulls a PointSet that the children share with the parent copy on write, with
+//the monotone chain, and
+//	ShardedHull<int> sh("points.bin", 8);
+//lets every child stream its part of a packed binary file through
+//ExternalHull, so no process ever holds more than its chunks.
+template<typename T = int, typename C = T>
+class ShardedHull
+{
+public:
+
+	//Number of worker processes
+	int workers;
+	//Where the hull goes, NULL for the default output of writeHull()
+	HullSink<T> *sink;
+
+	ShardedHull(PointSet<T> p, int workers) : points(move(p))
+	{
+		this->workers=max(workers,1);
+		sink=NULL;
+	}
+
+	ShardedHull(vector<pair<T,T> > p, int workers) : ShardedHull(PointSet<T>(p), workers) {}
+
+	ShardedHull(string path, int workers) : path(path)
+	{
+		this->workers=max(workers,1);
+		sink=NULL;
+	}
+
+	void convexHull()
+	{
+	    // A bad file is reported here once, not by every worker
+	    long long n = points.size();
+	    if (!path.empty())
+	    {
+	        struct stat st;
+	        if (stat(path.c_str(), &st) != 0)
+	            throw runtime_error("cannot stat " + path);
+	        if (st.st_size % (2 * sizeof(C)) != 0)
+	            throw runtime_error("binary point file is not a whole number of coordinate pairs");
+	        n = st.st_size / (2 * sizeof(C));
+	    }
+
+	    // Start every worker on its shard, [s*n/workers, (s+1)*n/workers)
+	    vector<pid_t> pids;
+	    vector<int> fds;
+	    for (int s = 0; s < workers; s++)
+	    {
+	        int fd[2];
+	        if (pipe(fd) != 0)
+	        {
+	            stop(pids, fds);
+	            throw runtime_error("cannot create a pipe");
+	        }
+	        pid_t pid = fork();
+	        if (pid < 0)
+	        {
+	            close(fd[0]);
+	            close(fd[1]);
+	            stop(pids, fds);
+	            throw runtime_error("cannot fork a worker");
+	        }
+	        if (pid == 0)
+	        {
+	            close(fd[0]);
+	            for (int i = 0; i < fds.size(); i++)
+	                close(fds[i]);
+	            int status = 0;
+	            try
+	            {
+	                vector<pair<T,T> > hull = shardHull(s * n / workers, (s + 1) * n / workers);
+	                long long h = hull.size();
+	                status = !(sendAll(fd[1], &h, sizeof(h)) && sendAll(fd[1], hull.data(), h * sizeof(pair<T,T>)));
+	            }
+	            catch (...)
+	            {
+	                status = 1;
+	            }
+	            _exit(status);
+	        }
+	        close(fd[1]);
+	        pids.push_back(pid);
+	        fds.push_back(fd[0]);
+	    }
+
+	    // Collect the partial hulls, then check how every worker ended
+	    vector<vector<pair<T,T> > > parts(workers);
+	    bool failed = false;
+	    for (int s = 0; s < workers; s++)
+	    {
+	        long long h = 0;
+	        if (recvAll(fds[s], &h, sizeof(h)) && h >= 0)
+	        {
+	            parts[s].resize(h);
+	            failed |= !recvAll(fds[s], parts[s].data(), h * sizeof(pair<T,T>));
+	        }
+	        else
+	            failed = true;
+	        close(fds[s]);
+	    }
+	    for (int s = 0; s < workers; s++)
+	    {
+	        int status;
+	        failed |= waitpid(pids[s], &status, 0) != pids[s] || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+	    }
+	    if (failed)
+	        throw runtime_error("a shard worker failed");
+	    writeHull(merge(parts), sink);
+	}
+
+	~ShardedHull(){}
+
+private:
+
+	PointSet<T> points;
+	string path;
+
+	// Hull of the points lo..hi-1, run in the worker
+	vector<pair<T,T> > shardHull(long long lo, long long hi)
+	{
+	    MemorySink<T> out;
+	    if (hi == lo)
+	        return out.vertices;
+	    if (!path.empty())
+	    {
+	        ExternalHull<T,C> e(path);
+	        e.first = lo;
+	        e.count = hi - lo;
+	        e.sink = &out;
+	        e.convexHull();
+	    }
+	    else
+	    {
+	        // The worker sorts its own copy on write of the slots
+	        vector<int> chain(hi - lo + 1);
+	        int h = monotoneChain(points, lo, hi, &chain[0]);
+	        for (int i = 0; i < h; i++)
+	            out.vertices.push_back(points.point(chain[i]));
+	    }
+	    return out.vertices;
+	}
+
+	// Hull of the partial hulls, merged pairwise up a tree. Each merge is one
+	// linear pass over two sorted vertex lists and one monotone chain pass,
+	// and only the vertices of its hull go up, so a level costs at most the H
+	// partial hull vertices and all of them O(H log k) for k workers.
+	vector<pair<T,T> > merge(vector<vector<pair<T,T> > > &parts)
+	{
+	    vector<vector<pair<T,T> > > level;
+	    for (int s = 0; s < parts.size(); s++)
+	        if (!parts[s].empty())
+	            level.push_back(move(parts[s]));
+	    if (level.empty())
+	        return vector<pair<T,T> >();
+	    while (level.size() > 1)
+	    {
+	        vector<vector<pair<T,T> > > up;
+	        for (int i = 0; i + 1 < level.size(); i += 2)
+	            up.push_back(mergeTwo(level[i], level[i+1]));
+	        if (level.size() % 2)
+	            up.push_back(move(level.back()));
+	        level.swap(up);
+	    }
+	    return level[0];
+	}
+
+	// Hull of two hulls. Each one is counterclockwise from its smallest
+	// point, so its vertices in (x, y) order are its lower chain merged with
+	// its upper chain reversed.
+	static vector<pair<T,T> > mergeTwo(const vector<pair<T,T> > &a, const vector<pair<T,T> > &b)
+	{
+	    vector<pair<T,T> > sa = sortedVertices(a), sb = sortedVertices(b);
+	    vector<pair<T,T> > sorted(sa.size() + sb.size());
+	    std::merge(sa.begin(), sa.end(), sb.begin(), sb.end(), sorted.begin());
+	    vector<pair<T,T> > hull(sorted.size() + 1);
+	    hull.resize(monotoneChainSorted(sorted.data(), sorted.size(), hull.data()));
+	    return hull;
+	}
+
+	static vector<pair<T,T> > sortedVertices(const vector<pair<T,T> > &v)
+	{
+	    int r = max_element(v.begin(), v.end()) - v.begin();
+	    vector<pair<T,T> > sorted(v.size());
+	    std::merge(v.begin(), v.begin() + r + 1, v.rbegin(), v.rend() - r - 1, sorted.begin());
+	    return sorted;
+	}
+
+	// Kills and reaps the workers started so far, after a failed start
+	static void stop(vector<pid_t> &pids, vector<int> &fds)
+	{
+	    for (int s = 0; s < pids.size(); s++)
+	    {
+	        close(fds[s]);
+	        kill(pids[s], SIGKILL);
+	        waitpid(pids[s], NULL, 0);
+	    }
+	}
+
+	static bool sendAll(int fd, const void *data, size_t bytes)
+	{
+	    for (size_t done = 0; done < bytes; )
+	    {
+	        ssize_t put = write(fd, (const char *)data + done, bytes - done);
+	        if (put <= 0)
+	            return false;
+	        done += put;
+	    }
+	    return true;
+	}
+
+	static bool recvAll(int fd, void *data, size_t bytes)
+	{
+	    for (size_t done = 0; done < bytes; )
+	    {
+	        ssize_t got = read(fd, (char *)data + done, bytes - done);
+	        if (got <= 0)
+	            return false;
+	        done += got;
+	    }
+	    return true;
+	}
+};
@@ -1,52 +1,557 @@
+#pragma once
 #include <bits/stdc++.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
 using namespace std;
 
 //Doubly linked list of points
-typedef struct node
+template<typename T>
+struct HullNode
 {
-	pair<int,int> p;
-	struct node* next;
-	struct node* prev;
-}Node;
+	pair<T,T> p;
+	HullNode* next;
+	HullNode* prev;
+};
+typedef HullNode<int> Node;
+
+//List of hull nodes that keeps both ends, so two lists join in constant time.
+//An empty list has a NULL head and tail.
+template<typename T>
+struct HullList
+{
+	HullNode<T>* head;
+	HullNode<T>* tail;
+
+	HullList() : head(NULL), tail(NULL) {}
+
+	//Appends the nodes of other after the last node of this list
+	void splice(HullList other)
+	{
+		if (!other.head)
+			return;
+		if (!head)
+		{
+			*this = other;
+			return;
+		}
+		tail->next = other.head;
+		other.head->prev = tail;
+		tail = other.tail;
+	}
+
+	//Copies the points to the end of out, skipping a point equal to the one
+	//before it
+	void exportTo(vector<pair<T,T> > &out)
+	{
+		for (HullNode<T>* temp = head; temp; temp = temp->next)
+			if (out.empty() || out.back() != temp->p)
+				out.push_back(temp->p);
+	}
+};
+
+//Pool of the hull nodes of one run. Nodes come out of blocks that double in
+//size and are all freed together when the arena is destroyed, nodes are never
+//freed one by one. make() may be called from several threads.
+template<typename T>
+class NodeArena
+{
+public:
+	NodeArena() : used(0), capacity(0) {}
+
+	//A list with the single point p
+	HullList<T> make(pair<T,T> p)
+	{
+		HullNode<T>* node;
+		{
+			lock_guard<mutex> lock(m);
+			if (used == capacity)
+			{
+				capacity = max(64, 2 * capacity);
+				blocks.push_back(unique_ptr<HullNode<T>[]>(new HullNode<T>[capacity]));
+				used = 0;
+			}
+			node = &blocks.back()[used++];
+		}
+		node->p = p;
+		node->next = NULL;
+		node->prev = NULL;
+		HullList<T> list;
+		list.head = list.tail = node;
+		return list;
+	}
+
+private:
+	vector<unique_ptr<HullNode<T>[]> > blocks;
+	int used, capacity;
+	mutex m;
+};
+
+//Arithmetic used by the geometric predicates, picked at compile time from the
+//coordinate type. Wide holds the product of two coordinate differences, so
+//narrow coordinates never pay for a wider type than they need:
+//	short       -> int        (exact while |coordinates| < 2^14)
+//	int         -> long long  (exact while |coordinates| < 2^30)
+//	long long   -> __int128   (exact while |coordinates| < 2^62)
+//	float/double -> double, with an error bound filter (see orient2dFiltered)
+template<typename T> struct Predicate;
+template<> struct Predicate<short> { typedef int Wide; };
+template<> struct Predicate<int> { typedef long long Wide; };
+template<> struct Predicate<long long> { typedef __int128 Wide; };
+template<> struct Predicate<float> { typedef double Wide; };
+template<> struct Predicate<double> { typedef double Wide; };
+
+//Error free transformations used by the exact fallback of orient2d. Each one
+//returns x, the rounded result of a op b, and sets y to the rounding error so
+//that a op b == x + y exactly.
+inline double twoSum(double a, double b, double &y)
+{
+    double x = a + b;
+    double bv = x - a, av = x - bv;
+    y = (a - av) + (b - bv);
+    return x;
+}
+
+inline double twoDiff(double a, double b, double &y)
+{
+    double x = a - b;
+    double bv = a - x, av = x + bv;
+    y = (a - av) + (bv - b);
+    return x;
+}
+
+inline double twoProduct(double a, double b, double &y)
+{
+    double x = a * b;
+#ifdef __FMA__
+    y = fma(a, b, -x);
+#else
+    // Dekker's split of a and b into 26 bit halves, their products are exact
+    const double splitter = 134217729.0;
+    double c = splitter * a, ahi = c - (c - a), alo = a - ahi;
+    c = splitter * b;
+    double bhi = c - (c - b), blo = b - bhi;
+    y = alo * blo - (((x - ahi * bhi) - alo * bhi) - ahi * blo);
+#endif
+    return x;
+}
+
+//Adds b to the expansion e[0..n), in place. An expansion is a sum of doubles
+//ordered by increasing magnitude that do not overlap, so its sign is the sign
+//of its last component. Zero components are dropped, e needs room for n+1.
+inline void growExpansion(double *e, int &n, double b)
+{
+    int k = 0;
+    for (int i = 0; i < n; i++)
+    {
+        double err;
+        b = twoSum(b, e[i], err);
+        if (err != 0)
+            e[k++] = err;
+    }
+    if (b != 0 || k == 0)
+        e[k++] = b;
+    n = k;
+}
+
+//twoProduct is only error free down to this magnitude. A smaller product has
+//lost low bits to underflow, and its error term with them.
+constexpr double productUnderflow = DBL_MIN / DBL_EPSILON;
+
+inline bool exactProduct(double a, double b)
+{
+    return a == 0 || b == 0 || fabs(a * b) >= productUnderflow;
+}
+
+//Sign of f[0]*f[1] + f[2]*f[3] + ... over at most 8 products, for the sums
+//with products that underflow. Every double is an integer of 53 bits times a
+//power of two, so each product is a 106 bit integer shifted by its exponent,
+//and the positive and the negative products are added up as fixed point
+//integers of 64 bit limbs. 72 limbs span the whole exponent range.
+inline int productSumSignFixed(const double *f, int terms)
+{
+    unsigned __int128 mag[8];
+    int ex[8], lo = INT_MAX;
+    bool neg[8];
+    for (int t = 0; t < terms; t++)
+    {
+        mag[t] = 0;
+        if (f[2*t] == 0 || f[2*t+1] == 0)
+            continue;
+        int ea, eb;
+        long long ma = (long long)ldexp(frexp(f[2*t], &ea), 53);
+        long long mb = (long long)ldexp(frexp(f[2*t+1], &eb), 53);
+        neg[t] = (ma < 0) != (mb < 0);
+        mag[t] = (unsigned __int128)llabs(ma) * (unsigned long long)llabs(mb);
+        ex[t] = ea + eb - 106;
+        lo = min(lo, ex[t]);
+    }
+    unsigned long long sum[2][72] = {};
+    for (int t = 0; t < terms; t++)
+    {
+        if (mag[t] == 0)
+            continue;
+        int q = (ex[t] - lo) / 64, r = (ex[t] - lo) % 64;
+        unsigned long long low = (unsigned long long)mag[t], high = (unsigned long long)(mag[t] >> 64);
+        unsigned long long w[3] = {low << r, r ? (low >> (64 - r)) | (high << r) : high, r ? high >> (64 - r) : 0};
+        unsigned long long *acc = sum[neg[t]], carry = 0;
+        for (int i = q; i < 72 && (i < q + 3 || carry); i++)
+        {
+            unsigned __int128 v = (unsigned __int128)acc[i] + (i < q + 3 ? w[i - q] : 0) + carry;
+            acc[i] = (unsigned long long)v;
+            carry = (unsigned long long)(v >> 64);
+        }
+    }
+    for (int i = 71; i >= 0; i--)
+        if (sum[0][i] != sum[1][i])
+            return sum[0][i] > sum[1][i] ? 1 : -1;
+    return 0;
+}
+
+//Sign of f[0]*f[1] + f[2]*f[3] + ... over at most 8 products, exactly. The
+//products and their error terms are summed as an expansion, unless one of
+//them underflows.
+inline int productSumSign(const double *f, int terms)
+{
+    for (int t = 0; t < terms; t++)
+        if (!exactProduct(f[2*t], f[2*t+1]))
+            return productSumSignFixed(f, terms);
+    double e[17];
+    int n = 0;
+    for (int t = 0; t < terms; t++)
+    {
+        double lo, hi = twoProduct(f[2*t], f[2*t+1], lo);
+        if (lo != 0)
+            growExpansion(e, n, lo);
+        if (hi != 0)
+            growExpansion(e, n, hi);
+    }
+    return n == 0 ? 0 : (e[n-1] > 0) - (e[n-1] < 0);
+}
+
+//Number of orient2d calls on floating point coordinates that the error bound
+//could not decide. adaptive counts the calls that went past the filter, exact
+//the ones among them that needed the full expansion. Only the slow paths
+//touch these, so the fast path stays free of shared writes.
+struct PredicateStats
+{
+    atomic<long long> adaptive{0}, exact{0};
+};
+inline PredicateStats predicateStats;
+
+//Sign of (b-a)x(c-a) computed exactly from the six products it expands to
+inline int orient2dExact(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    const double f[12] = {bx, cy, -bx, ay, -ax, cy, -by, cx, by, ax, ay, cx};
+    return productSumSign(f, 6);
+}
+
+//Slow path of orient2dFiltered(), kept out of line so that the filter stays
+//small enough to inline
+inline int orient2dAdaptive(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    // A zero factor in both products, det is exactly 0
+    if ((bx == ax || cy == ay) && (by == ay || cx == ax))
+        return 0;
+
+    predicateStats.adaptive.fetch_add(1, memory_order_relaxed);
+    double abxtail, acytail, abytail, acxtail;
+    double abx = twoDiff(bx, ax, abxtail), acy = twoDiff(cy, ay, acytail);
+    double aby = twoDiff(by, ay, abytail), acx = twoDiff(cx, ax, acxtail);
+    if (abxtail == 0 && acytail == 0 && abytail == 0 && acxtail == 0 && exactProduct(abx, acy) && exactProduct(aby, acx))
+    {
+        double e[5];
+        int n = 0;
+        double lo, hi = twoProduct(abx, acy, lo);
+        growExpansion(e, n, lo);
+        growExpansion(e, n, hi);
+        hi = twoProduct(aby, acx, lo);
+        growExpansion(e, n, -lo);
+        growExpansion(e, n, -hi);
+        return (e[n-1] > 0) - (e[n-1] < 0);
+    }
+    predicateStats.exact.fetch_add(1, memory_order_relaxed);
+    return orient2dExact(ax, ay, bx, by, cx, cy);
+}
+
+//Sign of the cross product (b-a)x(c-a) for floating point coordinates, after
+//Shewchuk's adaptive orient2d. The double result is used whenever it exceeds
+//the error bound, which is almost always on random data. Otherwise, if the
+//coordinate differences were exact the determinant is evaluated exactly from
+//their products, and failing that from the full expansion. Products that
+//underflow skip the filter and the expansions for productSumSignFixed().
+inline int orient2dFiltered(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    static constexpr double ccwerrboundA = (3.0 + 16.0 * DBL_EPSILON / 2) * DBL_EPSILON / 2;
+    static constexpr double errboundMin = ccwerrboundA * productUnderflow;
+    double detleft = (bx - ax) * (cy - ay);
+    double detright = (by - ay) * (cx - ax);
+    double det = detleft - detright;
+    // One well predicted branch on the fast path. The bound assumes that the
+    // products did not underflow, which holds above errboundMin.
+    double errbound = ccwerrboundA * (fabs(detleft) + fabs(detright));
+    if (fabs(det) > errbound && errbound >= errboundMin)
+        return (det > 0) - (det < 0);
+    return orient2dAdaptive(ax, ay, bx, by, cx, cy);
+}
+
+//Sign of (b-a)x(d-c) computed exactly from the eight products it expands to
+inline int cross2dExact(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy)
+{
+    const double f[16] = {bx, dy, -bx, cy, -ax, dy, ax, cy, -by, dx, by, cx, ay, dx, -ay, cx};
+    return productSumSign(f, 8);
+}
+
+//Slow path of cross2dFiltered()
+inline int cross2dAdaptive(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy)
+{
+    if ((bx == ax || dy == cy) && (by == ay || dx == cx))
+        return 0;
+
+    predicateStats.adaptive.fetch_add(1, memory_order_relaxed);
+    double abxtail, cdytail, abytail, cdxtail;
+    double abx = twoDiff(bx, ax, abxtail), cdy = twoDiff(dy, cy, cdytail);
+    double aby = twoDiff(by, ay, abytail), cdx = twoDiff(dx, cx, cdxtail);
+    if (abxtail == 0 && cdytail == 0 && abytail == 0 && cdxtail == 0 && exactProduct(abx, cdy) && exactProduct(aby, cdx))
+    {
+        double e[5];
+        int n = 0;
+        double lo, hi = twoProduct(abx, cdy, lo);
+        growExpansion(e, n, lo);
+        growExpansion(e, n, hi);
+        hi = twoProduct(aby, cdx, lo);
+        growExpansion(e, n, -lo);
+        growExpansion(e, n, -hi);
+        return (e[n-1] > 0) - (e[n-1] < 0);
+    }
+    predicateStats.exact.fetch_add(1, memory_order_relaxed);
+    return cross2dExact(ax, ay, bx, by, cx, cy, dx, dy);
+}
+
+//Sign of the cross product (b-a)x(d-c) of two directions, with the same
+//filter and fallbacks as orient2dFiltered. The bound holds unchanged because
+//each factor is still one rounded coordinate difference.
+inline int cross2dFiltered(double ax, double ay, double bx, double by, double cx, double cy, double dx, double dy)
+{
+    static constexpr double ccwerrboundA = (3.0 + 16.0 * DBL_EPSILON / 2) * DBL_EPSILON / 2;
+    static constexpr double errboundMin = ccwerrboundA * productUnderflow;
+    double detleft = (bx - ax) * (dy - cy);
+    double detright = (by - ay) * (dx - cx);
+    double det = detleft - detright;
+    double errbound = ccwerrboundA * (fabs(detleft) + fabs(detright));
+    if (fabs(det) > errbound && errbound >= errboundMin)
+        return (det > 0) - (det < 0);
+    return cross2dAdaptive(ax, ay, bx, by, cx, cy, dx, dy);
+}
+
+//Sign of the cross product (b-a)x(c-a): 1 if c is to the left of a->b,
+//-1 if it is to the right and 0 if the three points are colinear
+template<typename T>
+inline int orient2d(T ax, T ay, T bx, T by, T cx, T cy)
+{
+    if constexpr (is_floating_point<T>::value)
+        return orient2dFiltered(ax, ay, bx, by, cx, cy);
+    else
+    {
+        typedef typename Predicate<T>::Wide W;
+        W det = ((W)bx - ax) * ((W)cy - ay) - ((W)by - ay) * ((W)cx - ax);
+        return (det > 0) - (det < 0);
+    }
+}
+
+//Sign of the cross product (b-a)x(d-c): 1 if the direction c->d turns left
+//of a->b, -1 if it turns right and 0 if they are parallel
+template<typename T>
+inline int cross2d(T ax, T ay, T bx, T by, T cx, T cy, T dx, T dy)
+{
+    if constexpr (is_floating_point<T>::value)
+        return cross2dFiltered(ax, ay, bx, by, cx, cy, dx, dy);
+    else
+    {
+        typedef typename Predicate<T>::Wide W;
+        W det = ((W)bx - ax) * ((W)dy - cy) - ((W)by - ay) * ((W)dx - cx);
+        return (det > 0) - (det < 0);
+    }
+}
+
+//Allocator for the PointSet arrays. 32 byte alignment lets the vector loops
+//start on an AVX2 boundary.
+template<typename T>
+struct AlignedAllocator
+{
+	typedef T value_type;
+	AlignedAllocator() {}
+	template<typename U> AlignedAllocator(const AlignedAllocator<U> &) {}
+	T *allocate(size_t n)
+	{
+		void *p = aligned_alloc(32, (n * sizeof(T) + 31) / 32 * 32);
+		if (!p)
+			throw bad_alloc();
+		return (T *)p;
+	}
+	void deallocate(T *p, size_t) { free(p); }
+	template<typename U> bool operator==(const AlignedAllocator<U> &) const { return true; }
+	template<typename U> bool operator!=(const AlignedAllocator<U> &) const { return false; }
+};
+
+//Structure of arrays point container shared by all engines.
+//x[i], y[i] are the coordinates of the point in slot i, kept in separate
+//aligned arrays so the predicate loops vectorize. idx[i] is the position in
+//the original input of the point in slot i; it follows the points when an
+//engine sorts or compacts the slots, so idx is always a permutation of (a
+//subset of) the input positions.
+template<typename T = int>
+struct PointSet
+{
+	vector<T, AlignedAllocator<T> > x, y;
+	vector<int> idx;
+
+	PointSet() {}
+
+	PointSet(const vector<pair<T,T> > &p) : x(p.size()), y(p.size()), idx(p.size())
+	{
+		for (int i = 0; i < p.size(); i++)
+		{
+			x[i] = p[i].first;
+			y[i] = p[i].second;
+			idx[i] = i;
+		}
+	}
+
+	int size() const { return x.size(); }
+
+	pair<T,T> point(int i) const { return make_pair(x[i], y[i]); }
+
+	void push_back(pair<T,T> p)
+	{
+		idx.push_back(x.size());
+		x.push_back(p.first);
+		y.push_back(p.second);
+	}
+
+	// Sorts slots [lo,hi) by x and then by y. int points are packed into one
+	// 64 bit key (sign bits flipped so unsigned order matches signed order),
+	// which sorts faster than comparing the coordinates one by one.
+	void sortByX(int lo, int hi)
+	{
+		if constexpr (is_same<T,int>::value)
+		{
+			vector<pair<unsigned long long,int> > key(hi - lo);
+			for (int i = lo; i < hi; i++)
+				key[i - lo] = make_pair(((unsigned long long)((unsigned)x[i] ^ 0x80000000u) << 32) | ((unsigned)y[i] ^ 0x80000000u), idx[i]);
+			sort(key.begin(), key.end(), [](const pair<unsigned long long,int> &a, const pair<unsigned long long,int> &b) { return a.first < b.first; });
+			for (int i = lo; i < hi; i++)
+			{
+				x[i] = (int)((unsigned)(key[i - lo].first >> 32) ^ 0x80000000u);
+				y[i] = (int)((unsigned)key[i - lo].first ^ 0x80000000u);
+				idx[i] = key[i - lo].second;
+			}
+		}
+		else
+		{
+			vector<pair<pair<T,T>,int> > key(hi - lo);
+			for (int i = lo; i < hi; i++)
+				key[i - lo] = make_pair(point(i), idx[i]);
+			sort(key.begin(), key.end(), [](const pair<pair<T,T>,int> &a, const pair<pair<T,T>,int> &b) { return a.first < b.first; });
+			for (int i = lo; i < hi; i++)
+			{
+				x[i] = key[i - lo].first.first;
+				y[i] = key[i - lo].first.second;
+				idx[i] = key[i - lo].second;
+			}
+		}
+	}
+
+	// Keeps only the slots with keep[i] set, in their current order
+	void compact(const vector<char> &keep)
+	{
+		int k = 0;
+		for (int i = 0; i < size(); i++)
+		{
+			x[k] = x[i];
+			y[k] = y[i];
+			idx[k] = idx[i];
+			k += keep[i];
+		}
+		x.resize(k);
+		y.resize(k);
+		idx.resize(k);
+	}
+};
 
 //Utility function to check whether a point lies to the left of a line joining a to b or not
 //Function returns value:
 //	>0 if the point lies to the left
 //	=0 if the point lies on the line joining the two points a,b
 //	<0 if the point lies to the right
-int isLeft(pair<int,int> a, pair<int,int> b, pair<int,int> c){
-     int t = ((b.first - a.first)*(c.second - a.second) - (b.second - a.second)*(c.first - a.first));
-     return t;
+template<typename T>
+int isLeft(pair<T,T> a, pair<T,T> b, pair<T,T> c){
+     return orient2d(a.first, a.second, b.first, b.second, c.first, c.second);
 }
 
 //Utility function to find the slope between a pair of points
-double slope(pair<pair<int,int>,pair<int,int>> pairs)
+template<typename T>
+double slope(pair<pair<T,T>,pair<T,T>> pairs)
 {
     double slopeline=((double)pairs.second.second-(double)pairs.first.second)/((double)pairs.second.first-(double)pairs.first.first);
     return slopeline;
 }
 
+//Slope dy/dx of the line from a to b, for a left of b, kept as its two
+//endpoints. Slopes and intercepts compare by the sign of a cross product
+//through cross2d instead of a division, so every comparison is exact: for
+//integer coordinates in the ranges listed in Predicate, for float and double
+//through the filtered predicate.
+template<typename T>
+struct Slope
+{
+    pair<T,T> a, b;
+
+    Slope() {}
+    Slope(pair<T,T> a, pair<T,T> b) : a(a), b(b) {}
+
+    bool operator<(const Slope &o) const { return cross(o) > 0; }
+    bool operator==(const Slope &o) const { return cross(o) == 0; }
+
+    // Sign of the intercept of the line of this slope through p minus the
+    // one through q. Scaled by dx > 0 it is (b-a)x(p-q).
+    int compareIntercepts(pair<T,T> p, pair<T,T> q) const
+    {
+        return cross2d(a.first, a.second, b.first, b.second, q.first, q.second, p.first, p.second);
+    }
+
+    double value() const { return ((double)b.second - a.second) / ((double)b.first - a.first); }
+
+private:
+    int cross(const Slope &o) const
+    {
+        return cross2d(a.first, a.second, b.first, b.second, o.a.first, o.a.second, o.b.first, o.b.second);
+    }
+};
+
 //Utility function to sort the points by x-coordinate and in case of same x-coordinate
 //sort by y-coordinate in deccreasing order
-bool comparepointsuh(pair<int,int> a, pair<int,int> b)
+template<typename T>
+bool comparepointsuh(pair<T,T> a, pair<T,T> b)
 {
     return (a.first<b.first) || (a.first==b.first && a.second>b.second);
 }
 
 //Utility function to sort the points by x-coordinate and in case of same x-coordinate
 //sort by y-coordinate in increasing order
-bool comparepointslh(pair<int,int> a, pair<int,int> b)
+template<typename T>
+bool comparepointslh(pair<T,T> a, pair<T,T> b)
 {
     return (a.first<b.first) || (a.first==b.first && a.second<b.second);
 }
 
-pair<int,int> p0;
 // A utility function to find next to top in a stack
-pair<int,int> nextToTop(stack<pair<int,int>> &S) 
+template<typename T>
+pair<T,T> nextToTop(stack<pair<T,T>> &S) 
 { 
-    pair<int,int> p = S.top(); 
+    pair<T,T> p = S.top(); 
     S.pop(); 
-    pair<int,int> res = S.top(); 
+    pair<T,T> res = S.top(); 
     S.push(p); 
     return res; 
 }
@@ -59,36 +564,873 @@ void swap(pair<int,int> &p1, pair<int,int> &p2)
     p2 = temp; 
 }
 
-// A utility function to return square of distance between p1 and p2 
-int distSq(pair<int,int> p1, pair<int,int> p2) 
+// A utility function to return square of distance between p1 and p2, in the
+// wide type of the coordinates so it does not overflow
+template<typename T>
+typename Predicate<T>::Wide distSq(pair<T,T> p1, pair<T,T> p2) 
 { 
-    return (p1.first - p2.first)*(p1.first - p2.first) + (p1.second - p2.second)*(p1.second - p2.second); 
+    typedef typename Predicate<T>::Wide W;
+    W dx = (W)p1.first - p2.first, dy = (W)p1.second - p2.second;
+    return dx*dx + dy*dy; 
 } 
 
+// Whether b is farther from p than a, for p, a and b on one line. Along the
+// line the distances compare like the coordinate differences on an axis it
+// is not perpendicular to, so no squares are rounded for float and double:
+// on one side of p the coordinates compare directly, on opposite sides the
+// sign of (b-p)+(a-p) on that axis is summed exactly.
+template<typename T>
+bool fartherOnLine(pair<T,T> p, pair<T,T> a, pair<T,T> b)
+{
+    bool vertical = a.first == p.first && b.first == p.first;
+    T up = vertical ? p.second : p.first;
+    T ua = vertical ? a.second : a.first;
+    T ub = vertical ? b.second : b.first;
+    int sa = (ua > up) - (ua < up), sb = (ub > up) - (ub < up);
+    if (sb == 0)
+        return false;
+    if (sa == 0)
+        return true;
+    if (sa == sb)
+        return sb > 0 ? ub > ua : ub < ua;
+    int sum;
+    if constexpr (is_floating_point<T>::value)
+    {
+        double e[5];
+        int n = 0;
+        growExpansion(e, n, ub);
+        growExpansion(e, n, ua);
+        growExpansion(e, n, -(double)up);
+        growExpansion(e, n, -(double)up);
+        sum = (e[n-1] > 0) - (e[n-1] < 0);
+    }
+    else
+    {
+        typedef typename Predicate<T>::Wide W;
+        W d = (W)ub + ua - 2 * (W)up;
+        sum = (d > 0) - (d < 0);
+    }
+    return sb > 0 ? sum > 0 : sum < 0;
+}
+
 // To find orientation of ordered triplet (p, q, r). 
 // The function returns following values 
 // 0 --> p, q and r are colinear 
 // 1 --> Clockwise 
 // 2 --> Counterclockwise 
-int orientation(pair<int,int> p, pair<int,int> q, pair<int,int> r) 
+template<typename T>
+int orientation(pair<T,T> p, pair<T,T> q, pair<T,T> r) 
 { 
-    int val = (q.second - p.second) * (r.first - q.first) - (q.first - p.first) * (r.second - q.second); 
+    int val = isLeft(p, q, r); 
     if (val == 0) 
     	return 0;  // colinear 
-    return (val > 0)? 1: 2; // clock or counterclock wise 
+    return (val < 0)? 1: 2; // clock or counterclock wise 
 }
 
-// A function used by library function qsort() to sort an array of 
-// points with respect to the first point 
-int compare(const void *vp1, const void *vp2) 
-{ 
-   pair<int,int> *p1 = (pair<int,int> *)vp1; 
-   pair<int,int> *p2 = (pair<int,int> *)vp2; 
-  
-   // Find orientation 
-   int o = orientation(p0, *p1, *p2); 
-   if (o==0) 
-     return (distSq(p0, *p2) >= distSq(p0, *p1))? -1 : 1; 
-    
-   return (o == 2)? -1: 1; 
+//Andrew's monotone chain. Sorts slots [lo,hi) of ps by x and then by y and
+//writes the slots of the hull into out in counterclockwise order, starting
+//from the leftmost point. out must have room for hi-lo+1 slots. Collinear
+//points are dropped. Returns the number of hull vertices.
+//Nothing global is read or written, so separate calls can run at the same time.
+template<typename T>
+int monotoneChain(PointSet<T> &ps, int lo, int hi, int *out)
+{
+    ps.sortByX(lo, hi);
+    int k = 0;
+    // Lower chain, left to right
+    for (int i = lo; i < hi; i++)
+    {
+        while (k >= 2 && isLeft(ps.point(out[k-2]), ps.point(out[k-1]), ps.point(i)) <= 0)
+            k--;
+        out[k++] = i;
+    }
+    // Upper chain, right to left
+    for (int i = hi - 2, lower = k + 1; i >= lo; i--)
+    {
+        while (k >= lower && isLeft(ps.point(out[k-2]), ps.point(out[k-1]), ps.point(i)) <= 0)
+            k--;
+        out[k++] = i;
+    }
+    // The upper chain ends on the leftmost point again
+    if (k > 1)
+        k--;
+    // Only one distinct point
+    if (k == 2 && ps.point(out[0]) == ps.point(out[1]))
+        k = 1;
+    return k;
+}
+
+//The same monotone chain on n points that are already sorted by x and then by
+//y. Writes the hull into out, which must have room for n+1 points, and
+//returns its size.
+template<typename T>
+int monotoneChainSorted(const pair<T,T> *pts, int n, pair<T,T> *out)
+{
+    int k = 0;
+    for (int i = 0; i < n; i++)
+    {
+        while (k >= 2 && isLeft(out[k-2], out[k-1], pts[i]) <= 0)
+            k--;
+        out[k++] = pts[i];
+    }
+    for (int i = n - 2, lower = k + 1; i >= 0; i--)
+    {
+        while (k >= lower && isLeft(out[k-2], out[k-1], pts[i]) <= 0)
+            k--;
+        out[k++] = pts[i];
+    }
+    if (k > 1)
+        k--;
+    if (k == 2 && out[0] == out[1])
+        k = 1;
+    return k;
 }
+
+//Akl-Toussaint heuristic. Finds the extreme points in 8 directions (x, y, x+y
+//and x-y, both ways), or only the 4 axis directions if octagon is false, and
+//clears keep[i] for every point strictly inside the polygon they form, since
+//none of those can be on the hull, and sets it for the others. Points on its
+//boundary are kept. Returns false, with keep untouched, if there is no such
+//polygon.
+template<typename T>
+bool aklToussaintMark(const T *xs, const T *ys, int n, char *keep, bool octagon = true)
+{
+    typedef typename Predicate<T>::Wide W;
+    if (n < 4)
+        return false;
+
+    // ext[d] is the slot of the extreme point in direction d, counterclockwise
+    // from +x in steps of 45 degrees
+    int ext[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    for (int i = 1; i < n; i++)
+    {
+        W x = xs[i], y = ys[i];
+        if (x > xs[ext[0]]) ext[0] = i;
+        if (x + y > (W)xs[ext[1]] + ys[ext[1]]) ext[1] = i;
+        if (y > ys[ext[2]]) ext[2] = i;
+        if (y - x > (W)ys[ext[3]] - xs[ext[3]]) ext[3] = i;
+        if (x < xs[ext[4]]) ext[4] = i;
+        if (x + y < (W)xs[ext[5]] + ys[ext[5]]) ext[5] = i;
+        if (y < ys[ext[6]]) ext[6] = i;
+        if (x - y > (W)xs[ext[7]] - ys[ext[7]]) ext[7] = i;
+    }
+
+    // Polygon vertices in counterclockwise order, repeated points dropped
+    pair<T,T> poly[8];
+    int m = 0;
+    for (int d = 0; d < 8; d += octagon ? 1 : 2)
+        if (m == 0 || make_pair(xs[ext[d]], ys[ext[d]]) != poly[m-1])
+            poly[m++] = make_pair(xs[ext[d]], ys[ext[d]]);
+    while (m > 1 && poly[m-1] == poly[0])
+        m--;
+    if (m < 3)
+        return false;
+
+    // Every edge as a*(x - fx) + b*(y - fy), which is isLeft(from, to, p),
+    // padded to 8 edges by repeating the first one so the inner loop has a
+    // fixed length. Both products fit in W for the ranges listed in Predicate.
+    W a[8], b[8], fx[8], fy[8];
+    for (int e = 0; e < 8; e++)
+    {
+        int i = e < m ? e : 0;
+        pair<T,T> from = poly[i], to = poly[(i + 1) % m];
+        a[e] = -((W)to.second - from.second);
+        b[e] = (W)to.first - from.first;
+        fx[e] = from.first;
+        fy[e] = from.second;
+    }
+
+    // One branch free pass over the coordinate arrays marks the points to
+    // keep. Floating point
+    // coordinates go through the filtered predicate instead, since rounding
+    // in a*x + b*y + c could drop a point on the boundary.
+    for (int i = 0; i < n; i++)
+    {
+        bool inside = true;
+        if constexpr (is_floating_point<T>::value)
+        {
+            for (int e = 0; e < m; e++)
+                inside &= orient2d(poly[e].first, poly[e].second, poly[(e + 1) % m].first, poly[(e + 1) % m].second, xs[i], ys[i]) > 0;
+        }
+        else
+        {
+            W x = xs[i], y = ys[i];
+            for (int e = 0; e < 8; e++)
+                inside &= a[e] * (x - fx[e]) + b[e] * (y - fy[e]) > 0;
+        }
+        keep[i] = !inside;
+    }
+    return true;
+}
+
+//Same on a PointSet, the points inside are removed from it. Returns the
+//fraction of points removed.
+template<typename T>
+double aklToussaint(PointSet<T> &ps, bool octagon = true)
+{
+    int n = ps.size();
+    vector<char> keep(n);
+    if (!aklToussaintMark(ps.x.data(), ps.y.data(), n, keep.data(), octagon))
+        return 0;
+    ps.compact(keep);
+    return (double)(n - ps.size()) / n;
+}
+
+//Destination of a finished hull, given as its vertices in counterclockwise
+//order. Every engine has a sink member, NULL keeps the default output of
+//writeHull().
+template<typename T>
+class HullSink
+{
+public:
+	virtual void write(const vector<pair<T,T> > &hull) = 0;
+	virtual ~HullSink() {}
+};
+
+//Keeps the vertices in memory and does no I/O. vertices keeps its capacity
+//from one hull to the next.
+template<typename T>
+class MemorySink : public HullSink<T>
+{
+public:
+	vector<pair<T,T> > vertices;
+
+	void write(const vector<pair<T,T> > &hull) { vertices.assign(hull.begin(), hull.end()); }
+};
+
+//Writes the edges as text to path, one "x1 y1 x2 y2 1" line per edge like
+//testpoints.txt. The numbers are formatted with to_chars into a fixed buffer
+//that goes to the file whenever it fills up, nothing is allocated per edge.
+template<typename T>
+class TextSink : public HullSink<T>
+{
+public:
+	TextSink(string path) : path(path) {}
+
+	void write(const vector<pair<T,T> > &hull)
+	{
+		ofstream out(path.c_str(), ios::binary);
+		if (!out)
+			throw runtime_error("cannot open " + path);
+		char buf[1 << 16];
+		char *p = buf;
+		for (int i = 0; i < hull.size(); i++)
+		{
+			// One line is at most 4 numbers of 32 characters and 6 more
+			if (p + 140 > buf + sizeof(buf))
+			{
+				out.write(buf, p - buf);
+				p = buf;
+			}
+			pair<T,T> a = hull[i], b = hull[(i + 1) % hull.size()];
+			p = put(p, a.first, ' ');
+			p = put(p, a.second, ' ');
+			p = put(p, b.first, ' ');
+			p = put(p, b.second, ' ');
+			*p++ = '1';
+			*p++ = '\n';
+		}
+		out.write(buf, p - buf);
+	}
+
+private:
+	string path;
+
+	static char *put(char *p, T v, char after)
+	{
+		p = to_chars(p, p + 32, v).ptr;
+		*p++ = after;
+		return p;
+	}
+};
+
+//Writes the hull to path in a compact binary format: the 4 bytes "HULL", one
+//byte with sizeof(T), one byte that is 1 for floating point coordinates, two
+//zero bytes, the number of vertices as a uint64_t and then x and y of every
+//vertex as T, all in the byte order of the machine. The edges are implied,
+//vertex i to vertex i+1 and the last one back to the first.
+template<typename T>
+class BinarySink : public HullSink<T>
+{
+public:
+	BinarySink(string path) : path(path) {}
+
+	void write(const vector<pair<T,T> > &hull)
+	{
+		ofstream out(path.c_str(), ios::binary);
+		if (!out)
+			throw runtime_error("cannot open " + path);
+		char header[8] = {'H', 'U', 'L', 'L', (char)sizeof(T), (char)is_floating_point<T>::value, 0, 0};
+		uint64_t h = hull.size();
+		out.write(header, 8);
+		out.write((const char *)&h, sizeof(h));
+		static_assert(sizeof(pair<T,T>) == 2 * sizeof(T), "vertices are written as they lie in memory");
+		out.write((const char *)hull.data(), h * sizeof(pair<T,T>));
+	}
+
+	//Reads a hull written by write() back, empty if path is not such a file
+	//for this T
+	static vector<pair<T,T> > read(string path)
+	{
+		ifstream in(path.c_str(), ios::binary);
+		char header[8];
+		uint64_t h = 0;
+		vector<pair<T,T> > hull;
+		if (!in.read(header, 8) || memcmp(header, "HULL", 4) != 0 || header[4] != (char)sizeof(T) || header[5] != (char)is_floating_point<T>::value)
+			return hull;
+		if (!in.read((char *)&h, sizeof(h)))
+			return hull;
+		hull.resize(h);
+		if (!in.read((char *)hull.data(), h * sizeof(pair<T,T>)))
+			hull.clear();
+		return hull;
+	}
+
+private:
+	string path;
+};
+
+//Utility function to output a hull, given as its vertices in counterclockwise
+//order. With a sink the hull goes only there, by default its edges are written
+//to testpoints.txt and its vertices printed.
+template<typename T>
+void writeHull(const vector<pair<T,T> > &hull, HullSink<T> *sink = NULL)
+{
+    if (sink)
+    {
+        sink->write(hull);
+        return;
+    }
+    TextSink<T>("testpoints.txt").write(hull);
+    for (int i = 0; i < hull.size(); i++)
+        cout << "(" << hull[i].first << ", "<< hull[i].second << ")\n";
+}
+
+//Writes the hull of the first n slots of ps with the monotone chain, for the
+//engines whose own method needs more points than they were given. Every call
+//of an engine ends in writeHull(), so a reused sink never keeps the hull of
+//an earlier call: no points give an empty hull, collinear ones the segment
+//between the two ends.
+template<typename T>
+void writeSmallHull(PointSet<T> &ps, int n, HullSink<T> *sink)
+{
+    vector<int> chain(n + 1);
+    int h = monotoneChain(ps, 0, n, &chain[0]);
+    vector<pair<T,T> > hull(h);
+    for (int i = 0; i < h; i++)
+        hull[i] = ps.point(chain[i]);
+    writeHull(hull, sink);
+}
+
+//Returns true if b is a better next hull vertex than a, with both given relative
+//to the current vertex p: b is clockwise from a as seen from p, or on the same
+//ray and farther away. p itself, (0, 0), is never better than any point. The
+//differences fit in 32 bits, so the 64 bit products are exact.
+inline bool fartherClockwise(int ax, int ay, int bx, int by)
+{
+    long long cross = (long long)ax * by - (long long)ay * bx;
+    return cross < 0 || (cross == 0 && (long long)bx * bx + (long long)by * by > (long long)ax * ax + (long long)ay * ay);
+}
+
+//Scalar kernel for mostCounterclockwise(), also finishes the tails of the
+//vector kernels. best is the index of the best point found so far.
+int mostCounterclockwiseScalar(const int *xs, const int *ys, int lo, int hi, int px, int py, int best)
+{
+    for (int i = lo; i < hi; i++)
+        if (fartherClockwise(xs[best] - px, ys[best] - py, xs[i] - px, ys[i] - py))
+            best = i;
+    return best;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+//a*b - c*d for the even and for the odd 32 bit lanes, as 64 bit lanes.
+//_mm256_mul_epi32 multiplies the even lanes, the odd ones are shifted down.
+__attribute__((target("avx2")))
+inline void crossLanesAVX2(__m256i a, __m256i b, __m256i c, __m256i d, __m256i &even, __m256i &odd)
+{
+    even = _mm256_sub_epi64(_mm256_mul_epi32(a, b), _mm256_mul_epi32(c, d));
+    odd = _mm256_sub_epi64(_mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32)),
+                           _mm256_mul_epi32(_mm256_srli_epi64(c, 32), _mm256_srli_epi64(d, 32)));
+}
+
+//One AVX2 step: the lanes of (bx, by, bi) take the candidates (cx, cy, idx)
+//that are better than their current best. The products are 64 bit, the
+//masks of the even and odd lanes are interleaved back into 32 bit lanes.
+__attribute__((target("avx2")))
+inline void betterLanesAVX2(__m256i &bx, __m256i &by, __m256i &bi, __m256i cx, __m256i cy, __m256i idx)
+{
+    __m256i zero = _mm256_setzero_si256();
+    __m256i ce, co;
+    crossLanesAVX2(bx, cy, by, cx, ce, co);
+    __m256i better = _mm256_blend_epi32(_mm256_cmpgt_epi64(zero, ce), _mm256_cmpgt_epi64(zero, co), 0xAA);
+    // Distances are only needed when some lane is colinear
+    __m256i tie = _mm256_blend_epi32(_mm256_cmpeq_epi64(ce, zero), _mm256_cmpeq_epi64(co, zero), 0xAA);
+    if (!_mm256_testz_si256(tie, tie))
+    {
+        // |c|^2 - |b|^2 = cx*cx - (-cy)*cy - (bx*bx - (-by)*by)
+        __m256i nby = _mm256_sub_epi32(zero, by), ncy = _mm256_sub_epi32(zero, cy);
+        __m256i dbe, dbo, dce, dco;
+        crossLanesAVX2(bx, bx, nby, by, dbe, dbo);
+        crossLanesAVX2(cx, cx, ncy, cy, dce, dco);
+        __m256i farther = _mm256_blend_epi32(_mm256_cmpgt_epi64(dce, dbe), _mm256_cmpgt_epi64(dco, dbo), 0xAA);
+        better = _mm256_or_si256(better, _mm256_and_si256(tie, farther));
+    }
+    bx = _mm256_blendv_epi8(bx, cx, better);
+    by = _mm256_blendv_epi8(by, cy, better);
+    bi = _mm256_blendv_epi8(bi, idx, better);
+}
+
+//Utility function to reduce the best candidates of the vector lanes to one
+//index, equal points resolve to the lowest index
+int reduceLanes(const int *xs, const int *ys, const int *lane, int lanes, int px, int py)
+{
+    int best = lane[0];
+    for (int j = 1; j < lanes; j++)
+        if (fartherClockwise(xs[best] - px, ys[best] - py, xs[lane[j]] - px, ys[lane[j]] - py) ||
+            (lane[j] < best && !fartherClockwise(xs[lane[j]] - px, ys[lane[j]] - py, xs[best] - px, ys[best] - py)))
+            best = lane[j];
+    return best;
+}
+
+//AVX2 kernel: 16 points at a time in two independent sets of 8 lanes, so the
+//compare and blend of one set overlaps the multiplies of the other. Every lane
+//keeps its own best candidate, the lanes are reduced at the end.
+__attribute__((target("avx2")))
+int mostCounterclockwiseAVX2(const int *xs, const int *ys, int n, int px, int py)
+{
+    if (n < 32)
+        return mostCounterclockwiseScalar(xs, ys, 1, n, px, py, 0);
+    __m256i vpx = _mm256_set1_epi32(px), vpy = _mm256_set1_epi32(py);
+    __m256i idx0 = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), step = _mm256_set1_epi32(16);
+    __m256i idx1 = _mm256_add_epi32(idx0, _mm256_set1_epi32(8));
+    __m256i bi0 = idx0, bi1 = idx1;
+    __m256i bx0 = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)xs), vpx);
+    __m256i by0 = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)ys), vpy);
+    __m256i bx1 = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(xs + 8)), vpx);
+    __m256i by1 = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(ys + 8)), vpy);
+    int i = 16;
+    for (; i + 16 <= n; i += 16)
+    {
+        idx0 = _mm256_add_epi32(idx0, step);
+        idx1 = _mm256_add_epi32(idx1, step);
+        __m256i cx0 = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(xs + i)), vpx);
+        __m256i cy0 = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(ys + i)), vpy);
+        __m256i cx1 = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(xs + i + 8)), vpx);
+        __m256i cy1 = _mm256_sub_epi32(_mm256_loadu_si256((const __m256i *)(ys + i + 8)), vpy);
+        betterLanesAVX2(bx0, by0, bi0, cx0, cy0, idx0);
+        betterLanesAVX2(bx1, by1, bi1, cx1, cy1, idx1);
+    }
+    int lane[16];
+    _mm256_storeu_si256((__m256i *)lane, bi0);
+    _mm256_storeu_si256((__m256i *)(lane + 8), bi1);
+    int best = reduceLanes(xs, ys, lane, 16, px, py);
+    return mostCounterclockwiseScalar(xs, ys, i, n, px, py, best);
+}
+
+//a*b - c*d for the even and for the odd 32 bit lanes, as 64 bit lanes
+__attribute__((target("sse4.1")))
+inline void crossLanesSSE(__m128i a, __m128i b, __m128i c, __m128i d, __m128i &even, __m128i &odd)
+{
+    even = _mm_sub_epi64(_mm_mul_epi32(a, b), _mm_mul_epi32(c, d));
+    odd = _mm_sub_epi64(_mm_mul_epi32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32)),
+                        _mm_mul_epi32(_mm_srli_epi64(c, 32), _mm_srli_epi64(d, 32)));
+}
+
+//Mask of the 32 bit lanes whose 64 bit value of even or odd is negative. SSE4.1
+//has no 64 bit compare, the sign is the one of the high half.
+__attribute__((target("sse4.1")))
+inline __m128i negativeLanesSSE(__m128i even, __m128i odd)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i e = _mm_shuffle_epi32(_mm_cmpgt_epi32(zero, even), _MM_SHUFFLE(3, 3, 1, 1));
+    __m128i o = _mm_shuffle_epi32(_mm_cmpgt_epi32(zero, odd), _MM_SHUFFLE(3, 3, 1, 1));
+    return _mm_blend_epi16(e, o, 0xCC);
+}
+
+//SSE4.1 kernel, 4 points at a time in one set of lanes
+__attribute__((target("sse4.1")))
+int mostCounterclockwiseSSE(const int *xs, const int *ys, int n, int px, int py)
+{
+    if (n < 8)
+        return mostCounterclockwiseScalar(xs, ys, 1, n, px, py, 0);
+    __m128i vpx = _mm_set1_epi32(px), vpy = _mm_set1_epi32(py);
+    __m128i idx = _mm_setr_epi32(0, 1, 2, 3), step = _mm_set1_epi32(4);
+    __m128i zero = _mm_setzero_si128();
+    __m128i bi = idx;
+    __m128i bx = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)xs), vpx);
+    __m128i by = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)ys), vpy);
+    int i = 4;
+    for (; i + 4 <= n; i += 4)
+    {
+        idx = _mm_add_epi32(idx, step);
+        __m128i cx = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(xs + i)), vpx);
+        __m128i cy = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)(ys + i)), vpy);
+        __m128i ce, co;
+        crossLanesSSE(bx, cy, by, cx, ce, co);
+        __m128i better = negativeLanesSSE(ce, co);
+        // Distances are only needed when some lane is colinear
+        __m128i tie = _mm_blend_epi16(_mm_cmpeq_epi64(ce, zero), _mm_cmpeq_epi64(co, zero), 0xCC);
+        if (!_mm_testz_si128(tie, tie))
+        {
+            // |b|^2 - |c|^2 < 0, both sums of squares below 2^63
+            __m128i nby = _mm_sub_epi32(zero, by), ncy = _mm_sub_epi32(zero, cy);
+            __m128i dbe, dbo, dce, dco;
+            crossLanesSSE(bx, bx, nby, by, dbe, dbo);
+            crossLanesSSE(cx, cx, ncy, cy, dce, dco);
+            __m128i farther = negativeLanesSSE(_mm_sub_epi64(dbe, dce), _mm_sub_epi64(dbo, dco));
+            better = _mm_or_si128(better, _mm_and_si128(tie, farther));
+        }
+        bx = _mm_blendv_epi8(bx, cx, better);
+        by = _mm_blendv_epi8(by, cy, better);
+        bi = _mm_blendv_epi8(bi, idx, better);
+    }
+    int lane[4];
+    _mm_storeu_si128((__m128i *)lane, bi);
+    int best = reduceLanes(xs, ys, lane, 4, px, py);
+    return mostCounterclockwiseScalar(xs, ys, i, n, px, py, best);
+}
+#endif
+
+//Jarvis march step. Returns the index of the point q among xs[0..n), ys[0..n)
+//such that orientation(p, x, q) is counterclockwise or colinear for every other
+//point x, the farthest from p if several are colinear with it.
+//Uses AVX2 (16 points at a time) or SSE4.1 (4 at a time) when the cpu has them,
+//picked once at runtime, and a scalar loop otherwise. All kernels return the
+//same index: equal points resolve to the lowest index.
+int mostCounterclockwise(const int *xs, const int *ys, int n, int px, int py)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    static const int level = __builtin_cpu_supports("avx2") ? 2 : (__builtin_cpu_supports("sse4.1") ? 1 : 0);
+    if (level == 2)
+        return mostCounterclockwiseAVX2(xs, ys, n, px, py);
+    if (level == 1)
+        return mostCounterclockwiseSSE(xs, ys, n, px, py);
+#endif
+    return mostCounterclockwiseScalar(xs, ys, 1, n, px, py, 0);
+}
+
+//Jarvis march step for any coordinate type, on the exact predicates. Used
+//when the int kernels above could overflow: they subtract in 32 bits, so
+//they need every coordinate difference to fit in an int.
+template<typename T>
+int mostCounterclockwiseExact(const T *xs, const T *ys, int n, T px, T py)
+{
+    int best = 0;
+    for (int i = 1; i < n; i++)
+    {
+        int o = orient2d(px, py, xs[best], ys[best], xs[i], ys[i]);
+        if (o < 0 || (o == 0 && fartherOnLine(make_pair(px, py), make_pair(xs[best], ys[best]), make_pair(xs[i], ys[i]))))
+            best = i;
+    }
+    return best;
+}
+
+//Utility functions for linear time selection of the k-th smallest element.
+//selectKth() reorders the vector in place so that a[k] holds the element that
+//would be at index k after sorting, everything before it is not greater and
+//everything after it is not smaller (same contract as nth_element).
+//By default the pivot is a median of three (introselect); if the partitions stay
+//unbalanced for too long it falls back to the median of medians, so the worst
+//case stays O(n). Passing deterministic=true uses median of medians throughout.
+template<typename T, typename Compare>
+T selectRange(vector<T> &a, int lo, int hi, int k, Compare comp, bool deterministic);
+
+// A utility function to sort a small range [lo,hi) with insertion sort
+template<typename T, typename Compare>
+void insertionSort(vector<T> &a, int lo, int hi, Compare comp)
+{
+    for(int i=lo+1;i<hi;i++)
+    {
+        T key=a[i];
+        int j=i-1;
+        while(j>=lo && comp(key,a[j]))
+        {
+            a[j+1]=a[j];
+            j--;
+        }
+        a[j+1]=key;
+    }
+}
+
+// A utility function to find the median of medians of groups of five in [lo,hi).
+// The group medians are moved to the front of the range.
+template<typename T, typename Compare>
+T medianOfMedians(vector<T> &a, int lo, int hi, Compare comp)
+{
+    int groups=0;
+    for(int i=lo;i<hi;i+=5)
+    {
+        int end=min(i+5,hi);
+        insertionSort(a,i,end,comp);
+        swap(a[lo+groups],a[i+(end-i)/2]);
+        groups++;
+    }
+    return selectRange(a,lo,lo+groups,lo+groups/2,comp,true);
+}
+
+// A utility function to find the median of a[lo], a[mid] and a[hi-1]
+template<typename T, typename Compare>
+T medianOfThree(vector<T> &a, int lo, int hi, Compare comp)
+{
+    T x=a[lo], y=a[lo+(hi-lo)/2], z=a[hi-1];
+    if(comp(y,x))
+        swap(x,y);
+    if(comp(z,y))
+    {
+        y=z;
+        if(comp(y,x))
+            y=x;
+    }
+    return y;
+}
+
+template<typename T, typename Compare>
+T selectRange(vector<T> &a, int lo, int hi, int k, Compare comp, bool deterministic)
+{
+    // Number of median of three rounds allowed before switching to median of medians
+    int budget=deterministic ? 0 : 2*(__lg(max(hi-lo,1))+1);
+    while(hi-lo>5)
+    {
+        T pivot;
+        if(budget>0)
+        {
+            pivot=medianOfThree(a,lo,hi,comp);
+            budget--;
+        }
+        else
+            pivot=medianOfMedians(a,lo,hi,comp);
+
+        // Three way partition so that runs of equal elements (equal slopes,
+        // equal x-coordinates) end the search instead of slowing it down
+        int lt=lo, i=lo, gt=hi;
+        while(i<gt)
+        {
+            if(comp(a[i],pivot))
+                swap(a[lt++],a[i++]);
+            else if(comp(pivot,a[i]))
+                swap(a[i],a[--gt]);
+            else
+                i++;
+        }
+        if(k<lt)
+            hi=lt;
+        else if(k>=gt)
+            lo=gt;
+        else
+            return a[k];
+    }
+    insertionSort(a,lo,hi,comp);
+    return a[k];
+}
+
+template<typename T, typename Compare>
+T selectKth(vector<T> &a, int k, Compare comp, bool deterministic=false)
+{
+    return selectRange(a,0,a.size(),k,comp,deterministic);
+}
+
+template<typename T>
+T selectKth(vector<T> &a, int k)
+{
+    return selectRange(a,0,a.size(),k,less<T>(),false);
+}
+
+//Tracing of the KirkPatrickSeidel recursion. It compiles to nothing unless
+//KPS_TRACE is defined before the headers are included, then every hull call and
+//every bridge round records one event in a fixed size ring buffer of the
+//engine. Nothing is printed or allocated, the oldest events are overwritten.
+struct TraceEvent
+{
+	enum Kind { Hull, Bridge };
+	Kind kind;
+	//1 for the upper hull, -1 for the lower hull
+	int side;
+	//Depth of the hull recursion, 0 for the whole upper or lower hull
+	int depth;
+	//Round of the bridge, 0 for a hull event
+	int round;
+	//Points of the hull call or candidates of the bridge round
+	int count;
+};
+
+class TraceRing
+{
+public:
+	static const int Size = 1 << 12;
+
+	//Safe from several threads, each event gets its own slot unless more
+	//than Size events are recorded while one is being written
+	void record(TraceEvent e)
+	{
+		unsigned i = next++;
+		events[i % Size] = e;
+	}
+
+	//Number of events recorded since the last clear(), overwritten ones too
+	unsigned recorded() const { return next; }
+
+	//The events still in the buffer, oldest first
+	vector<TraceEvent> snapshot() const
+	{
+		unsigned end = next, begin = end > Size ? end - Size : 0;
+		vector<TraceEvent> out;
+		for (unsigned i = begin; i < end; i++)
+			out.push_back(events[i % Size]);
+		return out;
+	}
+
+	void clear() { next = 0; }
+
+private:
+	TraceEvent events[Size];
+	atomic<unsigned> next{0};
+};
+
+#ifdef KPS_TRACE
+#define KPS_TRACE_EVENT(ring, kind, side, depth, round, count) (ring).record(TraceEvent{TraceEvent::kind, side, depth, round, count})
+#else
+#define KPS_TRACE_EVENT(ring, kind, side, depth, round, count) ((void)0)
+#endif
+
+//Work stealing thread pool for the parallel modes. Every worker owns a deque:
+//it pushes and pops its own tasks at the back, idle workers steal from the
+//front of the others, so a recursion spawned on one worker spreads out from
+//its largest (oldest) subproblems. Threads that are not workers of the pool
+//push into one shared deque. A task is counted in a Group when spawned and
+//wait() runs other tasks until every task of the group has finished, so a
+//task can spawn and wait on its own subtasks without blocking a worker.
+class TaskPool
+{
+public:
+	struct Group
+	{
+		atomic<int> pending{0};
+	};
+
+	TaskPool(int threads = thread::hardware_concurrency()) : queues(max(threads, 1) + 1)
+	{
+		for (int i = 0; i < queues.size(); i++)
+			queues[i].reset(new Queue);
+		for (int i = 0; i < max(threads, 1); i++)
+			workers.push_back(thread([this, i]() { work(i); }));
+	}
+
+	~TaskPool()
+	{
+		{
+			lock_guard<mutex> lock(sleep);
+			stop = true;
+		}
+		wake.notify_all();
+		for (int i = 0; i < workers.size(); i++)
+			workers[i].join();
+	}
+
+	int size() const { return workers.size(); }
+
+	void spawn(Group &g, function<void()> task)
+	{
+		g.pending++;
+		Queue &q = *queues[self()];
+		{
+			lock_guard<mutex> lock(q.m);
+			q.tasks.push_back([&g, task]() { task(); g.pending--; });
+		}
+		queued++;
+		{
+			lock_guard<mutex> lock(sleep);
+		}
+		wake.notify_one();
+	}
+
+	void wait(Group &g)
+	{
+		while (g.pending > 0)
+			if (!runOne(self()))
+				this_thread::yield();
+	}
+
+	// Number of chunks to cut n items into so that every chunk has at least
+	// grain items and every worker gets a few of them
+	int chunks(int n, int grain)
+	{
+		return max(1, min(4 * size(), n / max(grain, 1)));
+	}
+
+	// Runs body(c, lo, hi) for every chunk c of [0,n) cut into count chunks,
+	// chunk c being [c*n/count, (c+1)*n/count), and waits for all of them.
+	// The calling thread runs the first chunk itself.
+	template<typename F>
+	void forChunks(int n, int count, F body)
+	{
+		Group g;
+		for (int c = 1; c < count; c++)
+			spawn(g, [&body, c, n, count]() { body(c, (long long)c * n / count, (long long)(c + 1) * n / count); });
+		body(0, 0, n / count);
+		wait(g);
+	}
+
+private:
+	struct Queue
+	{
+		mutex m;
+		deque<function<void()> > tasks;
+	};
+
+	vector<unique_ptr<Queue> > queues;
+	vector<thread> workers;
+	atomic<int> queued{0};
+	bool stop = false;
+	mutex sleep;
+	condition_variable wake;
+
+	// Deque of the calling thread, the last one for threads outside the pool
+	int self()
+	{
+		return current.first == this ? current.second : queues.size() - 1;
+	}
+
+	static inline thread_local pair<TaskPool *, int> current{NULL, 0};
+
+	// Pops a task of the own deque, or steals one, and runs it
+	bool runOne(int me)
+	{
+		function<void()> task;
+		for (int k = 0; k < queues.size() && !task; k++)
+		{
+			Queue &q = *queues[(me + k) % queues.size()];
+			lock_guard<mutex> lock(q.m);
+			if (q.tasks.empty())
+				continue;
+			if (k == 0)
+			{
+				task = move(q.tasks.back());
+				q.tasks.pop_back();
+			}
+			else
+			{
+				task = move(q.tasks.front());
+				q.tasks.pop_front();
+			}
+		}
+		if (!task)
+			return false;
+		queued--;
+		task();
+		return true;
+	}
+
+	void work(int me)
+	{
+		current = make_pair(this, me);
+		while (true)
+		{
+			if (runOne(me))
+				continue;
+			unique_lock<mutex> lock(sleep);
+			wake.wait(lock, [this]() { return stop || queued > 0; });
+			if (stop)
+				return;
+		}
+	}
+};
@@ -1,44 +1,81 @@
+#pragma once
 #include "UtilFunction.h"
 
+template<typename T = int>
 class GrahamScan
 {
 public:
 
-	vector<pair<int,int> > points;
+	PointSet<T> points;
 	int n;
+	//Fraction of the points removed by the prefilter in the last call
+	double reduction;
+	//Where the hull goes, NULL for the default output of writeHull()
+	HullSink<T> *sink;
 
-	GrahamScan(vector<pair<int,int> > p)
+	GrahamScan(PointSet<T> p) : points(move(p))
 	{
-		for(int i=0;i<p.size();i++)
-		{
-			points.push_back(make_pair(p[i].first,p[i].second));
-		}
+		n=points.size();
+		reduction=0;
+		sink=NULL;
+	}
+
+	GrahamScan(vector<pair<T,T> > p) : GrahamScan(PointSet<T>(p)) {}
+
+	// Drops the points that are strictly inside the Akl-Toussaint octagon
+	void prefilter()
+	{
+		reduction=aklToussaint(points);
 		n=points.size();
 	}
 
-	void convexHull() 
+	void convexHull(bool filter = false) 
 	{ 
+	   if (filter)
+	      prefilter();
+
+	   // There must be at least 3 points, the scan starts from three
+	   if (n < 3)
+	   {
+	      writeSmallHull(points, n, sink);
+	      return;
+	   }
+
+	   // The points are visited through ord, a permutation of the slots,
+	   // the coordinates themselves are not moved
+	   vector<int> ord(n);
+	   for (int i = 0; i < n; i++)
+	      ord[i] = i;
+
 	   // Find the bottommost point 
-	   int ymin = points[0].second, min = 0; 
+	   T ymin = points.y[0]; int min = 0; 
 	   for (int i = 1; i < n; i++) 
 	   { 
-	     int y = points[i].second; 
+	     T y = points.y[i]; 
 	  
 	     // Pick the bottom-most or chose the left 
 	     // most point in case of tie 
-	     if ((y < ymin) || (ymin == y && points[i].first < points[min].first)) 
-	        ymin = points[i].second, min = i; 
+	     if ((y < ymin) || (ymin == y && points.x[i] < points.x[min])) 
+	        ymin = points.y[i], min = i; 
 	   } 
 	  
 	   // Place the bottom-most point at first position 
-	   swap(points[0], points[min]); 
+	   swap(ord[0], ord[min]); 
 	  
 	   // Sort n-1 points with respect to the first point. 
 	   // A point p1 comes before p2 in sorted ouput if p2 
 	   // has larger polar angle (in counterclockwise 
-	   // direction) than p1 
-	   p0 = points[0]; 
-	   qsort(&points[1], n-1, sizeof(pair<int,int>), compare); 
+	   // direction) than p1. p0 is local so no global
+	   // state is used.
+	   pair<T,T> p0 = points.point(ord[0]); 
+	   sort(ord.begin() + 1, ord.end(), [&](int a, int b)
+	   {
+	      pair<T,T> p1 = points.point(a), p2 = points.point(b);
+	      int o = orientation(p0, p1, p2);
+	      if (o == 0)
+	         return fartherOnLine(p0, p1, p2);
+	      return o == 2;
+	   });
 	  
 	   // If two or more points make same angle with p0, 
 	   // Remove all but the one that is farthest from p0 
@@ -50,25 +87,28 @@ public:
 	   { 
 	       // Keep removing i while angle of i and i+1 is same 
 	       // with respect to p0 
-	       while (i < n-1 && orientation(p0, points[i], points[i+1]) == 0) 
+	       while (i < n-1 && orientation(p0, points.point(ord[i]), points.point(ord[i+1])) == 0) 
 	          i++; 
 	  
 	  
-	       points[m] = points[i]; 
+	       ord[m] = ord[i]; 
 	       m++;  // Update size of modified array 
 	   } 
 	  
 	   // If modified array of points has less than 3 points, 
-	   // convex hull is not possible 
+	   // they are all on one line through p0 
 	   if (m < 3) 
-			return; 
+	   {
+	      writeSmallHull(points, n, sink);
+	      return; 
+	   }
 	  
 	   // Create an empty stack and push first three points 
 	   // to it. 
-	   stack<pair<int,int> > S; 
-	   S.push(points[0]); 
-	   S.push(points[1]); 
-	   S.push(points[2]); 
+	   stack<pair<T,T> > S; 
+	   S.push(points.point(ord[0])); 
+	   S.push(points.point(ord[1])); 
+	   S.push(points.point(ord[2])); 
 	  
 	   // Process remaining n-3 points 
 	   for (int i = 3; i < m; i++) 
@@ -76,531 +116,871 @@ public:
 	      // Keep removing top while the angle formed by 
 	      // points next-to-top, top, and points[i] makes 
 	      // a non-left turn 
-	      while (orientation(nextToTop(S), S.top(), points[i]) != 2) 
+	      while (orientation(nextToTop(S), S.top(), points.point(ord[i])) != 2) 
 	         S.pop(); 
-	      S.push(points[i]); 
+	      S.push(points.point(ord[i])); 
 	   } 
 	  
-	   // Now stack has the output points, print contents of stack
-	   pair<int, int>store_pt = S.top();
-	   pair<int, int>temp_pt = S.top();
-	   vector<string>v;
-	   string final_str = "";
-	   string temp_str = to_string(temp_pt.first) + " " + to_string(temp_pt.second) + " ";
-	   S.pop(); 
-	   while (!S.empty()) 
-	   { 
-	       pair<int,int> p = S.top();
-	       temp_str += to_string(p.first) + " " + to_string(p.second) + " 1\n";
-	       final_str += temp_str;
-	       cout << "(" << p.first << ", " << p.second <<")" << endl;
-	       temp_str = to_string(p.first) + " " + to_string(p.second) + " ";
-	       S.pop(); 
+	   // Now stack has the output points, counterclockwise from p0 when
+	   // read from the bottom
+	   vector<pair<T,T> > hull(S.size());
+	   for (int i = hull.size() - 1; i >= 0; i--)
+	   {
+	       hull[i] = S.top();
+	       S.pop();
+	   }
+	   writeHull(hull, sink);
+	}
+
+	// Andrew's monotone chain mode. Sorts on (x, y) with an inlined std::sort
+	// instead of qsort() around the global p0, and builds both chains in one
+	// preallocated array instead of a stack, so no global state is touched and
+	// several hulls can be computed at the same time.
+	void convexHullMonotone(bool filter = false)
+	{
+	   if (filter)
+	      prefilter();
+
+	   // If there are less than 3 points, convex hull is not possible
+	   if (n < 3)
+	   {
+	      writeSmallHull(points, n, sink);
+	      return;
 	   }
-	   final_str += temp_str + to_string(store_pt.first) + " " + to_string(store_pt.second) + " 1\n";
-	   ofstream myfile;
-	   myfile.open("testpoints.txt");
-	   myfile << final_str;
-	   myfile.close();
+
+	   vector<int> chain(n + 1);
+	   int h = monotoneChain(points, 0, n, &chain[0]);
+	   vector<pair<T,T> > hull(h);
+	   for (int i = 0; i < h; i++)
+	      hull[i] = points.point(chain[i]);
+	   writeHull(hull, sink);
 	}
 	~GrahamScan(){};
 };
 
+template<typename T = int>
 class JarvisMarch
 {
 public:
 
-	vector<pair<int,int> > points;
+	PointSet<T> points;
 	int n;
 
-	JarvisMarch(vector<pair<int,int> > p)
+	//Fraction of the points removed by the prefilter in the last call
+	double reduction;
+	//Where the hull goes, NULL for the default output of writeHull()
+	HullSink<T> *sink;
+
+	JarvisMarch(PointSet<T> p) : points(move(p))
 	{
-		for(int i=0;i<p.size();i++)
-		{
-			points.push_back(make_pair(p[i].first,p[i].second));			
-		}
+		n=points.size();
+		reduction=0;
+		sink=NULL;
+	}
+
+	JarvisMarch(vector<pair<T,T> > p) : JarvisMarch(PointSet<T>(p)) {}
+
+	// Drops the points that are strictly inside the Akl-Toussaint octagon
+	void prefilter()
+	{
+		reduction=aklToussaint(points);
 		n=points.size();
 	}
 
-	void convexHull() 
+	void convexHull(bool filter = false) 
 	{ 
+	    if (filter)
+	        prefilter();
+
 	    // There must be at least 3 points 
 	    if (n < 3) 
+	    {
+	        writeSmallHull(points, n, sink);
 	    	return; 
+	    }
 	  
 	    // Initialize Result 
-	    vector<pair<int,int> > hull; 
+	    vector<pair<T,T> > hull; 
 	  
-	    // Find the leftmost point 
+	    // Find the leftmost point, the lowest one in case of tie so that it
+	    // is a corner of the hull
 	    int l = 0; 
 	    for (int i = 1; i < n; i++) 
-	        if (points[i].first < points[l].first) 
+	        if (points.point(i) < points.point(l)) 
 	            l = i; 
+
+	    // The vector kernels need int coordinates whose differences fit in
+	    // an int, their products are 64 bit
+	    bool fast = false;
+	    if constexpr (is_same<T,int>::value)
+	    {
+	        auto [xlo, xhi] = minmax_element(points.x.begin(), points.x.begin() + n);
+	        auto [ylo, yhi] = minmax_element(points.y.begin(), points.y.begin() + n);
+	        fast = (long long)*xhi - *xlo <= INT_MAX && (long long)*yhi - *ylo <= INT_MAX;
+	    }
 	  
 	    // Start from leftmost point, keep moving counterclockwise 
 	    // until reach the start point again.  This loop runs O(h) 
 	    // times where h is number of points in result or output.
 
-	    vector<string>str;
-	    string temp_str = to_string(points[l].first) + " " + to_string(points[l].second) + " "; 
 	    int p = l, q; 
 	    do
 	    { 
+	        // The hull has at most n vertices. A longer walk means that the
+	        // predicates contradicted each other, and it might never get
+	        // back to l, so the monotone chain gives the hull instead.
+	        if (hull.size() == n)
+	        {
+	            vector<int> chain(n + 1);
+	            int h = monotoneChain(points, 0, n, &chain[0]);
+	            hull.clear();
+	            for (int i = 0; i < h; i++)
+	                hull.push_back(points.point(chain[i]));
+	            break;
+	        }
+
 	        // Add current point to result 
-	        hull.push_back(points[p]); 
+	        hull.push_back(points.point(p)); 
 	  
 	        // Search for a point 'q' such that orientation(p, x, 
 	        // q) is counterclockwise for all points 'x'. The idea 
 	        // is to keep track of last visited most counterclock- 
 	        // wise point in q. If any point 'i' is more counterclock- 
-	        // wise than q, then update q. 
-	        q = (p+1)%n; 
-	        for (int i = 0; i < n; i++) 
-	        { 
-	           // If i is more counterclockwise than current q, then 
-	           // update q 
-	           if (orientation(points[p], points[i], points[q]) == 2) 
-	               q = i; 
-	        } 
+	        // wise than q, then update q. If they are colinear with p
+	        // the farther one is kept. The kernel checks 8 points at
+	        // a time where the cpu allows it, straight off the
+	        // coordinate arrays of the point set. Spans too wide for the
+	        // kernels' int differences go through the exact loop.
+	        if constexpr (is_same<T,int>::value)
+	            q = fast ? mostCounterclockwise(&points.x[0], &points.y[0], n, points.x[p], points.y[p])
+	                     : mostCounterclockwiseExact(&points.x[0], &points.y[0], n, points.x[p], points.y[p]); 
+	        else
+	            q = mostCounterclockwiseExact(&points.x[0], &points.y[0], n, points.x[p], points.y[p]); 
 	  
 	        // Now q is the most counterclockwise with respect to p 
 	        // Set p as q for next iteration, so that q is added to 
 	        // result 'hull' 
 	        p = q;
-	        temp_str +=  to_string(points[p].first) + " " + to_string(points[p].second) + " 1";
-	        str.push_back(temp_str);
-	        temp_str = to_string(points[p].first) + " " + to_string(points[p].second) + " ";
 	  
 	    } while (p != l);  // While we don't come to first point 
-		
-		ofstream myfile;
-		myfile.open("testpoints.txt");
-		temp_str = "";
-	    for(int x = 0; x < str.size(); x++) {
-	    	temp_str += str[x] + "\n";
-	    }
-	    myfile << temp_str;
-	    myfile.close();
-
-	    // Print Result 
-	    for (int i = 0; i < hull.size(); i++) 
-	        cout << "(" << hull[i].first << ", "<< hull[i].second << ")\n"; 
+
+	    writeHull(hull, sink);
 	} 
 	~JarvisMarch(){};	
 };
 
-int iterb = 1, iterh = 1;
-class KirkPatrickSeidel
+template<typename T = int>
+class ChanHull
 {
-	public:
+public:
+
+	PointSet<T> points;
+	int n;
 
-	vector<pair<int,int>> points;
+	//Fraction of the points removed by the prefilter in the last call
+	double reduction;
+	//Where the hull goes, NULL for the default output of writeHull()
+	HullSink<T> *sink;
 
-	KirkPatrickSeidel(vector<pair<int,int>> v)
+	ChanHull(PointSet<T> p) : points(move(p))
 	{
-		for(int i=0;i<v.size();i++)
-		{
-			points.push_back(v[i]);
-		}
+		n=points.size();
+		reduction=0;
+		sink=NULL;
 	}
 
-	pair<pair<int,int>, pair<int, int> > upperBridge(vector<pair<int,int>>s,pair<int,int>l)
+	ChanHull(vector<pair<T,T> > p) : ChanHull(PointSet<T>(p)) {}
+
+	// Drops the points that are strictly inside the Akl-Toussaint octagon
+	void prefilter()
 	{
-		cout<<"Hull iteration : "<<iterh - 1<<endl;
-		sort(s.begin(), s.end());
-		cout<<"Points in "<<iterb++<<" are : \n";
-		for (int i = 0; i < s.size(); ++i)
-		{
-			cout<<s[i].first<<" "<<s[i].second<<endl;
-		}
-		cout<<"End points \n";
+		reduction=aklToussaint(points);
+		n=points.size();
+	}
 
-		vector<pair<int,int> > cand;
-	    int n = s.size();
-	    // sort(s.begin(),s.end());
-	    if(n==2)
+	// Returns true if b is a better next hull vertex than a when wrapping from p,
+	// i.e. b lies to the right of the line p->a, or on it but farther from p.
+	// p itself is never better than any other point.
+	bool better(pair<T,T> p, pair<T,T> a, pair<T,T> b)
+	{
+	    int o = orientation(p, a, b);
+	    if (o == 0)
+	        return fartherOnLine(p, a, b);
+	    return o == 1;
+	}
+
+	// Builds the counterclockwise hull of slots [lo,hi) with a monotone chain
+	// and appends its vertices to mini, collinear points are dropped
+	void miniHull(int lo, int hi, vector<int> &chain, vector<pair<T,T> > &mini)
+	{
+	    int h = monotoneChain(points, lo, hi, &chain[0]);
+	    for (int i = 0; i < h; i++)
+	        mini.push_back(points.point(chain[i]));
+	}
+
+	// Binary search for the vertex of the counterclockwise polygon h[lo..hi) that
+	// is the best next hull vertex from p. Seen from p the vertices get better
+	// along one arc of the polygon and worse along the other, so the answer is
+	// the only vertex better than both its neighbours.
+	int tangent(vector<pair<T,T> > &h, int lo, int hi, pair<T,T> p)
+	{
+	    int k = hi - lo;
+	    if (k <= 3)
 	    {
-	        sort(s.begin(),s.end());
-	        return make_pair(s[0],s[1]);
+	        int best = lo;
+	        for (int i = lo + 1; i < hi; i++)
+	            if (better(p, h[best], h[i]))
+	                best = i;
+	        return best;
 	    }
-	    vector<pair<pair<int,int>,pair<int,int>>> pairs;
-	    vector<double> k;
-	    vector< pair< double, pair< pair< int, int >,pair< int,int > > > > slope_pair;
-	    bool flag=true;
-	    for(int i=0;i<=n-2;i+=2)
+	    // Vertex i of the polygon, indices wrap around
+	    auto at = [&](int i) { return h[lo + i % k]; };
+	    bool zeroWorsening = !better(p, at(0), at(1));
+	    if (zeroWorsening && !better(p, at(0), at(k-1)))
+	        return lo;
+	    int l = 1, r = k;
+	    while (l < r)
 	    {
-	        if(s[i].first<s[i+1].first)
-	            pairs.push_back(make_pair(s[i],s[i+1]));
+	        int mid = (l + r) / 2;
+	        bool worsening = !better(p, at(mid), at(mid + 1));
+	        bool goRight;
+	        if (zeroWorsening)
+	            goRight = !worsening || !better(p, at(0), at(mid));
+	        else
+	            goRight = !worsening && better(p, at(0), at(mid));
+	        if (goRight)
+	            l = mid + 1;
 	        else
-	            pairs.push_back(make_pair(s[i+1],s[i]));
-	        if(i==n-2)
-	            flag=false;
+	            r = mid;
 	    }
-	    if(flag)
-	        cand.push_back(s[n-1]);
-	    cout<<"Points in pairs : \n";
-		for (int i = 0; i < pairs.size(); ++i)
-		{
-			cout<<pairs[i].first.first<<" "<<pairs[i].first.second<<" and "<<pairs[i].second.first<<" "<<pairs[i].second.second<<endl;
-		}
-		cout<<"End points \n";
-	    for(int i=0;i<pairs.size();i++)
+	    return lo + l;
+	}
+
+	// Attempts to wrap the hull using groups of m points, returns false if the
+	// hull has more than m vertices
+	bool wrap(int m, vector<pair<T,T> > &hull)
+	{
+	    // Hull of every group, stored one after the other in mini
+	    vector<pair<T,T> > mini;
+	    vector<int> offset, chain(m + 1);
+	    for (int lo = 0; lo < n; lo += m)
+	    {
+	        offset.push_back(mini.size());
+	        miniHull(lo, min(lo + m, n), chain, mini);
+	    }
+	    offset.push_back(mini.size());
+
+	    // Start from the leftmost point, lowest in case of tie
+	    pair<T,T> start = points.point(0);
+	    for (int i = 1; i < n; i++)
+	        if (points.point(i) < start)
+	            start = points.point(i);
+
+	    hull.clear();
+	    pair<T,T> p = start;
+	    for (int step = 0; step < m; step++)
 	    {
-	        if(pairs[i].first.first==pairs[i].second.first)
+	        hull.push_back(p);
+	        // Best tangent point of every group, then the best of those
+	        pair<T,T> q = p;
+	        for (int g = 0; g + 1 < offset.size(); g++)
 	        {
-	            if(pairs[i].first.second>pairs[i].second.second)
-	                cand.push_back(pairs[i].first);
-	            else
-	                cand.push_back(pairs[i].second);
+	            pair<T,T> c = mini[tangent(mini, offset[g], offset[g+1], p)];
+	            if (better(p, q, c))
+	                q = c;
 	        }
-	        else
-	        {
-	            double temp=slope(pairs[i]);
-	            k.push_back(temp);
-	            slope_pair.push_back(make_pair(temp,pairs[i]));
-	        }        
+	        if (q == start || q == p)
+	            return true;
+	        p = q;
 	    }
-	    sort(k.begin(),k.end());
-	    cout<<"Slope size and points : "<<k.size()<<endl;
-	    for (int i = 0; i < k.size(); ++i)
+	    return false;
+	}
+
+	void convexHull(bool filter = false)
+	{
+	    if (filter)
+	        prefilter();
+
+	    // There must be at least 3 points
+	    if (n < 3)
 	    {
-	    	cout<<k[i]<<endl;
+	        writeSmallHull(points, n, sink);
+	        return;
 	    }
-	    double midslope;
-	    // if(k.size()%2==0)
-	    // {
-	        // midslope=(k[k.size()/2]+k[(k.size()/2)-1])/2;
-	    // }
-	    // else
-	        midslope=k[k.size()/2];
 
-	    vector<pair<pair<int,int>,pair<int,int>>> small,equal,large;
-	    for(int i=0;i<slope_pair.size();i++)
+	    // Guess h with m = 2^(2^t), squaring the guess after every failed wrap,
+	    // so the total work stays O(n log h)
+	    vector<pair<T,T> > hull;
+	    long long m = 4;
+	    while (!wrap(min(m, (long long)n), hull) && m < n)
+	        m = m * m;
+
+	    writeHull(hull, sink);
+	}
+	~ChanHull(){};
+};
+
+template<typename T = int>
+class ParallelHull
+{
+public:
+
+	PointSet<T> points;
+	int n;
+	//Number of threads, the input is cut into this many x-slabs
+	int threads;
+	//Fraction of the points removed by the prefilter in the last call
+	double reduction;
+	//Where the hull goes, NULL for the default output of writeHull()
+	HullSink<T> *sink;
+
+	ParallelHull(PointSet<T> p, int threads = thread::hardware_concurrency()) : points(move(p))
+	{
+		n=points.size();
+		this->threads=max(threads,1);
+		reduction=0;
+		sink=NULL;
+	}
+
+	ParallelHull(vector<pair<T,T> > p, int threads = thread::hardware_concurrency()) : ParallelHull(PointSet<T>(p), threads) {}
+
+	// Drops the points that are strictly inside the Akl-Toussaint octagon
+	void prefilter()
+	{
+		reduction=aklToussaint(points);
+		n=points.size();
+	}
+
+	// True if the line through p1 and p2 is at least as high as the line
+	// through q1 and q2 at x = m. Neither line is vertical. Both heights are
+	// scaled by the two (positive) x-extents, which needs three factors, so
+	// int coordinates use __int128 and the others long double.
+	bool higherAt(pair<T,T> p1, pair<T,T> p2, pair<T,T> q1, pair<T,T> q2, T m)
+	{
+	    typedef typename conditional<is_integral<T>::value && sizeof(T) <= 4, __int128, long double>::type E;
+	    E dx1 = (E)p2.first - p1.first, dy1 = (E)p2.second - p1.second;
+	    E dx2 = (E)q2.first - q1.first, dy2 = (E)q2.second - q1.second;
+	    E hp = ((E)m - p1.first) * dy1 * dx2;
+	    E hq = (((E)q1.second - p1.second) * dx2 + ((E)m - q1.first) * dy2) * dx1;
+	    return hp >= hq;
+	}
+
+	// Bridge of the chains a and b, both strictly increasing in x with all of
+	// a left of all of b: the upper common tangent if sgn is 1, the lower one
+	// if sgn is -1. Returns its endpoints, the outermost ones if more points
+	// lie on it. Overmars and van Leeuwen's simultaneous binary search, every
+	// step drops part of the range of a or of b, O(log |a| + log |b|) steps.
+	pair<int,int> bridge(const vector<pair<T,T> > &a, const vector<pair<T,T> > &b, int sgn)
+	{
+	    int ilo = 0, ihi = a.size() - 1, jlo = 0, jhi = b.size() - 1;
+	    T m = a.back().first;
+	    while (true)
 	    {
-	        if(slope_pair[i].first<midslope)
+	        int i = (ilo + ihi) / 2, j = (jlo + jhi + 1) / 2;
+	        // Neighbours on the outer side of the line a[i] b[j]
+	        auto out = [&](pair<T,T> p) { return isLeft(a[i], b[j], p) * sgn > 0; };
+	        bool nextA = i + 1 < a.size() && out(a[i+1]);
+	        bool prevA = i > 0 && out(a[i-1]);
+	        bool prevB = j > 0 && out(b[j-1]);
+	        bool nextB = j + 1 < b.size() && out(b[j+1]);
+	        if (!nextA && !prevA && !prevB && !nextB)
 	        {
-	            small.push_back(slope_pair[i].second);
+	            if (i > 0 && isLeft(a[i], b[j], a[i-1]) == 0)
+	                i--;
+	            if (j + 1 < b.size() && isLeft(a[i], b[j], b[j+1]) == 0)
+	                j++;
+	            return make_pair(i, j);
 	        }
-	        else if(slope_pair[i].first==midslope)
+	        // a[i] or b[j] supports its own chain: the bridge does not end
+	        // right of it on a, nor left of it on b
+	        if (prevA)
+	            ihi = i - 1;
+	        else if (!nextA)
+	            ihi = i;
+	        if (nextB)
+	            jlo = j + 1;
+	        else if (!prevB)
+	            jlo = j;
+	        if (nextA && prevB)
 	        {
-	            equal.push_back(slope_pair[i].second);
-	        } 
-	        else
-	        {
-	            large.push_back(slope_pair[i].second);
+	            // The lines of the edges a[i] a[i+1] and b[j-1] b[j] cross, the
+	            // side of the last x of a they cross on tells which one can go
+	            bool left = sgn > 0 ? higherAt(a[i], a[i+1], b[j-1], b[j], m) : higherAt(b[j-1], b[j], a[i], a[i+1], m);
+	            if (left)
+	                ilo = i + 1;
+	            else
+	                jhi = j - 1;
 	        }
+	        else if (nextA && jlo == jhi && j == jlo)
+	            ilo = i + 1;
+	        else if (prevB && ilo == ihi && i == ilo)
+	            jhi = j - 1;
 	    }
+	}
 
-	    double maxval=INT_MIN;
-	    for(int i=0;i<n;i++)
+	// Joins the chains a and b (see bridge()) into a, b is left empty
+	void merge(vector<pair<T,T> > &a, vector<pair<T,T> > &b, int sgn)
+	{
+	    if (b.empty())
+	        return;
+	    if (!a.empty())
 	    {
-	        if(((double)s[i].second-(midslope*(double)s[i].first))>maxval)
-	            maxval=(double)s[i].second-(midslope*(double)s[i].first);
-
+	        pair<int,int> br = bridge(a, b, sgn);
+	        a.resize(br.first + 1);
+	        a.insert(a.end(), b.begin() + br.second, b.end());
 	    }
+	    else
+	        a.swap(b);
+	    b.clear();
+	    b.shrink_to_fit();
+	}
 
-	    cout<<"max val of intercept : "<<maxval<<endl;
-	    vector<pair<int,int>> maxset;
-	    pair<int,int> pmax=make_pair(INT_MIN,INT_MIN);
-	    pair<int,int> pmin=make_pair(INT_MAX,INT_MAX);
-	    for(int i=0;i<n;i++)
+	void convexHull(bool filter = false)
+	{
+	    if (filter)
+	        prefilter();
+
+	    // There must be at least 3 points
+	    if (n < 3)
 	    {
-	    	cout<<"s[i] : "<<s[i].first<<" "<<s[i].second<<endl;
-	        if(maxval==((double)s[i].second-(midslope*(double)s[i].first)))
-	        {
-	            maxset.push_back(s[i]);
-	            if(pmax.first<s[i].first)
-	            {
-	                pmax.first=s[i].first;
-	                pmax.second=s[i].second;
-	            }
-	            if(pmin.first>s[i].first)
-	            {
-	                pmin.first=s[i].first;
-	                pmin.second=s[i].second;
-	            }
-	        }
+	        writeSmallHull(points, n, sink);
+	        return;
 	    }
-	    cout<<"pmin : "<<pmin.first<<" "<<pmin.second<<" and pmax : "<<pmax.first<<" "<<pmax.second<<endl;
-	    if(pmin.first<=l.first && pmax.first>l.first)
+
+	    TaskPool pool(threads);
+	    int slabs = threads;
+
+	    // Slab boundaries at the quantiles of a regular sample of the
+	    // x-coordinates. Points with the same x always share a slab, so the
+	    // slabs are strictly apart in x.
+	    vector<T> sample;
+	    for (int i = 0; i < n; i += max(1, n / (64 * slabs)))
+	        sample.push_back(points.x[i]);
+	    sort(sample.begin(), sample.end());
+	    vector<T> split(slabs - 1);
+	    for (int s = 1; s < slabs; s++)
+	        split[s-1] = sample[(long long)s * sample.size() / slabs];
+	    auto slabOf = [&](T x) { return int(upper_bound(split.begin(), split.end(), x) - split.begin()); };
+
+	    // Count the points of every slab chunk by chunk, then every chunk
+	    // copies its points to its own range of every slab
+	    int parts = pool.chunks(n, 1 << 15);
+	    vector<vector<int> > at(parts, vector<int>(slabs, 0));
+	    pool.forChunks(n, parts, [&](int c, int lo, int hi)
 	    {
-	    	cout<<"***********************************************Points returned during " << (iterb - 1) << " iteration : "<<pmin.first<<" "<<pmin.second<<" and "<<pmax.first<<" "<<pmax.second<<endl;
-	        return make_pair(pmin,pmax);
-	    }
-	    if(pmax.first<=l.first)
+	        for (int i = lo; i < hi; i++)
+	            at[c][slabOf(points.x[i])]++;
+	    });
+	    vector<int> begin(slabs + 1, 0);
+	    for (int s = 0, pos = 0; s < slabs; s++)
 	    {
-	        for(int i=0;i<small.size();i++)
-	        {
-	            cand.push_back(small[i].first);
-	            cand.push_back(small[i].second);
-	        }
-	        for(int i=0;i<large.size();i++)
-	        {
-	            cand.push_back(large[i].second);
-	        }
-	        for(int i=0;i<equal.size();i++)
+	        begin[s] = pos;
+	        for (int c = 0; c < parts; c++)
 	        {
-	            cand.push_back(equal[i].second);
+	            int count = at[c][s];
+	            at[c][s] = pos;
+	            pos += count;
 	        }
 	    }
-	    if(pmin.first>l.first)
+	    begin[slabs] = n;
+	    PointSet<T> ps;
+	    ps.x.resize(n);
+	    ps.y.resize(n);
+	    ps.idx.resize(n);
+	    pool.forChunks(n, parts, [&](int c, int lo, int hi)
 	    {
-	        for(int i=0;i<large.size();i++)
+	        for (int i = lo; i < hi; i++)
 	        {
-	            cand.push_back(large[i].first);
-	            cand.push_back(large[i].second);
+	            int &pos = at[c][slabOf(points.x[i])];
+	            ps.x[pos] = points.x[i];
+	            ps.y[pos] = points.y[i];
+	            ps.idx[pos] = points.idx[i];
+	            pos++;
 	        }
-	        for(int i=0;i<small.size();i++)
+	    });
+
+	    // Monotone chain on every slab at the same time, split into its lower
+	    // and upper chains, both left to right
+	    vector<vector<pair<T,T> > > lower(slabs), upper(slabs);
+	    pool.forChunks(slabs, slabs, [&](int c, int lo, int hi)
+	    {
+	        for (int s = lo; s < hi; s++)
 	        {
-	            cand.push_back(small[i].first);
+	            int size = begin[s+1] - begin[s];
+	            if (size == 0)
+	                continue;
+	            vector<int> chain(size + 1);
+	            int h = monotoneChain(ps, begin[s], begin[s+1], &chain[0]);
+	            vector<pair<T,T> > v(h);
+	            for (int i = 0; i < h; i++)
+	                v[i] = ps.point(chain[i]);
+	            // Counterclockwise from the leftmost lowest point: the lower
+	            // chain runs to the first point with the largest x, the upper
+	            // chain from the last one back to the leftmost highest point
+	            int r = 0;
+	            while (r + 1 < h && v[r+1].first > v[r].first)
+	                r++;
+	            int r2 = r;
+	            while (r2 + 1 < h && v[r2+1].first == v[r].first)
+	                r2++;
+	            lower[s].assign(v.begin(), v.begin() + r + 1);
+	            upper[s].assign(v.begin() + r2, v.end());
+	            if (v.back().first != v[0].first || h == 1)
+	                upper[s].push_back(v[0]);
+	            reverse(upper[s].begin(), upper[s].end());
 	        }
-	        for(int i=0;i<equal.size();i++)
+	    });
+
+	    // Merge neighbouring slabs pairwise, log(slabs) rounds
+	    for (int width = 1; width < slabs; width *= 2)
+	    {
+	        int pairs = (slabs + 2 * width - 1) / (2 * width);
+	        pool.forChunks(pairs, pairs, [&](int c, int lo, int hi)
 	        {
-	            cand.push_back(equal[i].first);
-	        }
+	            for (int p = lo; p < hi; p++)
+	            {
+	                int s = 2 * width * p;
+	                if (s + width >= slabs)
+	                    continue;
+	                merge(lower[s], lower[s + width], -1);
+	                merge(upper[s], upper[s + width], 1);
+	            }
+	        });
 	    }
-	    return upperBridge(cand,l);
+
+	    // Lower chain left to right, then the upper chain right to left
+	    vector<pair<T,T> > hull = lower[0];
+	    for (int i = upper[0].size() - 1; i >= 0; i--)
+	        if (hull.back() != upper[0][i])
+	            hull.push_back(upper[0][i]);
+	    while (hull.size() > 1 && hull.back() == hull[0])
+	        hull.pop_back();
+	    writeHull(hull, sink);
 	}
+	~ParallelHull(){};
+};
+
+template<typename T = int>
+class QuickHull
+{
+public:
 
-	Node* upperhull(pair<int,int> pmin, pair<int,int> pmax,vector<pair<int, int>> v)
+	PointSet<T> points;
+	int n;
+	//Fraction of the points removed by the prefilter in the last call
+	double reduction;
+	//Where the hull goes, NULL for the default output of writeHull()
+	HullSink<T> *sink;
+	//Pool of the threaded mode, NULL when running sequentially
+	TaskPool *pool;
+	//Subproblems with fewer points than this are not split into tasks
+	int cutoff;
+
+	QuickHull(PointSet<T> p) : points(move(p))
 	{
-		iterh++;
-		int n = v.size();
-		sort(v.begin(), v.end());
-	    if(pmin.first == pmax.first && pmin.second == pmax.second)
-	    {
-	        Node* head=(Node *)malloc(sizeof(Node));
-	        head->p.first=pmin.first;
-	        head->p.second=pmin.second;
-	        head->prev=NULL;
-	        head->next=NULL;
-	        return head;
-	    }
-	    pair<int,int> x_med;
-		if(n%2==0)
-			x_med= v[n/2];
-		else
-			x_med= v[n/2];
-	    vector<pair<int, int> >tleft, tright;
-	    for(int i = 0;i < n; i++)
+		n=points.size();
+		reduction=0;
+		sink=NULL;
+		pool=NULL;
+		cutoff=1<<12;
+	}
+
+	QuickHull(vector<pair<T,T> > p) : QuickHull(PointSet<T>(p)) {}
+
+	// Drops the points that are strictly inside the Akl-Toussaint octagon
+	void prefilter()
+	{
+		reduction=aklToussaint(points);
+		n=points.size();
+	}
+
+	// Runs left and right, as two tasks if the pool is on and the
+	// subproblem has at least cutoff points
+	template<typename L, typename R>
+	void both(int size, L left, R right)
+	{
+	    if (pool && size >= cutoff)
 	    {
-	        //FATAL : ADDED EQUAL CONDITION
-	        if(v[i].first <= x_med.first)
-	        {
-	            tleft.push_back(v[i]);
-	        }
-	        else
-	        {
-	            tright.push_back(v[i]);
-	        }
+	        TaskPool::Group g;
+	        pool->spawn(g, left);
+	        right();
+	        pool->wait(g);
 	    }
-	    pair<pair<int, int>, pair<int, int> > plpr;
-	    plpr = upperBridge(v, x_med);
-	    pair<int,int> pl=plpr.first;
-	    pair<int,int> pr=plpr.second;
-	    vector<pair<int,int>> ntleft,ntright;
-	    ntleft.push_back(pl);
-	    ntleft.push_back(pmin);
-	    ntright.push_back(pr);
-	    ntright.push_back(pmax);
-
-	    for(int i=0;i<tleft.size();i++)
+	    else
 	    {
-	        if(isLeft(pmin,pl,tleft[i])>0 && tleft[i].first > pmin.first && tleft[i].first < pl.first)
-	        {
-	            ntleft.push_back(tleft[i]);
-	        }        
+	        left();
+	        right();
 	    }
-	    for(int i=0;i<tright.size();i++)
+	}
+
+	// Hull vertices strictly between a and b, the slots ord[lo,hi) being the
+	// points strictly right of a->b. The range is partitioned in place around
+	// c, the farthest point from a->b, into the points right of a->c, c and
+	// the points right of c->b, the others are dropped. Returns the number of
+	// vertices, which are left in ord[lo,lo+count) in counterclockwise order.
+	int hull(vector<int> &ord, int lo, int hi, pair<T,T> a, pair<T,T> b)
+	{
+	    if (hi - lo <= 1)
+	        return hi - lo;
+
+	    // Farthest from the line, the one farthest along a->b among equals so
+	    // that c is a vertex and not a point inside an edge. p is farther than
+	    // f when (b-a)x(f-p) > 0, decided by cross2d so it is exact for float
+	    // and double too. Equals lie on a parallel to a->b, where the order
+	    // along a->b is the (x, y) order, reversed if b comes before a.
+	    bool forward = a < b;
+	    int far = lo;
+	    for (int i = lo + 1; i < hi; i++)
 	    {
-	        if(isLeft(pr,pmax,tright[i])>0 && tright[i].first > pr.first && tright[i].first < pmax.first)
-	        {
-	            ntright.push_back(tright[i]);
-	        }        
+	        pair<T,T> p = points.point(ord[i]), f = points.point(ord[far]);
+	        int s = cross2d(a.first, a.second, b.first, b.second, p.first, p.second, f.first, f.second);
+	        if (s > 0 || (s == 0 && (forward ? f < p : p < f)))
+	            far = i;
 	    }
-	    Node* left=upperhull(pmin,pl,ntleft);
-	    Node* right=upperhull(pr,pmax,ntright);
+	    swap(ord[far], ord[hi-1]);
+	    int cs = ord[hi-1];
+	    pair<T,T> c = points.point(cs);
+
+	    int mid = partition(ord.begin() + lo, ord.begin() + hi - 1, [&](int s) { return isLeft(a, c, points.point(s)) < 0; }) - ord.begin();
+	    swap(ord[mid], ord[hi-1]);
+	    int end = partition(ord.begin() + mid + 1, ord.begin() + hi, [&](int s) { return isLeft(c, b, points.point(s)) < 0; }) - ord.begin();
+
+	    int left, right;
+	    both(hi - lo, [&]() { left = hull(ord, lo, mid, a, c); }, [&]() { right = hull(ord, mid + 1, end, c, b); });
+
+	    // Both results move down next to each other with c between them
+	    ord[lo + left] = cs;
+	    if (lo + left + 1 < mid + 1)
+	        copy(ord.begin() + mid + 1, ord.begin() + mid + 1 + right, ord.begin() + lo + left + 1);
+	    return left + 1 + right;
+	}
+
+	void convexHull(bool filter = false)
+	{
+	    if (filter)
+	        prefilter();
 
-	    if(left == NULL) {
-	        left = right;
-	        return left;
+	    // There must be at least 3 points
+	    if (n < 3)
+	    {
+	        writeSmallHull(points, n, sink);
+	        return;
 	    }
 
-	    Node* temp=left;
-	    while(temp->next)
+	    // The lowest of the leftmost points and the highest of the rightmost
+	    // ones are vertices, the line through them cuts the rest in two
+	    int first = 0, last = 0;
+	    for (int i = 1; i < n; i++)
 	    {
-	        temp=temp->next;
+	        if (points.point(i) < points.point(first))
+	            first = i;
+	        if (points.point(last) < points.point(i))
+	            last = i;
 	    }
-	    temp->next=right;
-	    
-	    return left;
+	    pair<T,T> a = points.point(first), b = points.point(last);
+
+	    vector<int> ord(n);
+	    for (int i = 0; i < n; i++)
+	        ord[i] = i;
+	    int mid = partition(ord.begin(), ord.end(), [&](int s) { return isLeft(a, b, points.point(s)) < 0; }) - ord.begin();
+	    int end = partition(ord.begin() + mid, ord.end(), [&](int s) { return isLeft(b, a, points.point(s)) < 0; }) - ord.begin();
+
+	    int lower, upper;
+	    both(n, [&]() { lower = hull(ord, 0, mid, a, b); }, [&]() { upper = hull(ord, mid, end, b, a); });
+
+	    // Counterclockwise from the leftmost point, like the other engines
+	    vector<pair<T,T> > hull;
+	    hull.push_back(a);
+	    for (int i = 0; i < lower; i++)
+	        hull.push_back(points.point(ord[i]));
+	    if (b != a)
+	        hull.push_back(b);
+	    for (int i = 0; i < upper; i++)
+	        hull.push_back(points.point(ord[mid + i]));
+	    writeHull(hull, sink);
 	}
 
-	
-
+	// Threaded mode of convexHull(), the two sides of every subproblem with
+	// at least cutoff points run as tasks on a pool of the given number of
+	// threads
+	void convexHullParallel(int threads, bool filter = false)
+	{
+	    TaskPool tasks(threads);
+	    pool = &tasks;
+	    convexHull(filter);
+	    pool = NULL;
+	}
 
+	~QuickHull(){};
+};
 
-	int iterlb = 1;
-	int iterlh = 1;
+template<typename T = int>
+class KirkPatrickSeidel
+{
+	public:
 
+	PointSet<T> points;
+	//Use median of medians instead of introselect for the median slope and x-median
+	bool deterministicSelect;
+	//Fraction of the points removed by the prefilter in the last call
+	double reduction;
+	//Where the hull goes, NULL for the default output of writeHull()
+	HullSink<T> *sink;
+	//Pool of the parallel mode, NULL when running sequentially
+	TaskPool *pool;
+	//Hull subproblems with fewer points than this are not split into tasks
+	int cutoff;
+	//The loops of the bridges are split over the pool above this many points
+	int grain;
+	//Nodes of the hull lists of the running kps() call
+	NodeArena<T> *arena;
+	//Number of sorts of the last kps() or kpsInPlace() call
+	int sorts;
+#ifdef KPS_TRACE
+	//Events of the last kps() or kpsInPlace() call, see TraceRing
+	TraceRing traceRing;
+#endif
+	//Working buffers of kpsInPlace(), sized once and kept for the next call:
+	//the slots of every subproblem, a copy the bridges prune, the slopes of
+	//one bridge round and the hull slots found so far
+	vector<int> buf, work, chain;
+	vector<Slope<T> > slopes;
+
+	//The hull works on slots of the point set: every vector below holds slot
+	//numbers and the coordinates are read from points.x and points.y
+
+	KirkPatrickSeidel(PointSet<T> p, bool deterministic = false) : points(move(p))
+	{
+		deterministicSelect = deterministic;
+		reduction = 0;
+		sink = NULL;
+		pool = NULL;
+		cutoff = 1 << 12;
+		grain = 1 << 15;
+		arena = NULL;
+		sorts = 0;
+	}
 
+	KirkPatrickSeidel(vector<pair<T,T>> v, bool deterministic = false) : KirkPatrickSeidel(PointSet<T>(v), deterministic) {}
 
-	pair<pair<int,int>, pair<int, int> > lowerBridge(vector<pair<int,int>>s,pair<int,int>l)
+	// Drops the points that are strictly inside the Akl-Toussaint octagon
+	void prefilter()
 	{
-		cout<<"Hull iteration : "<<iterlh - 1<<endl;
+		reduction = aklToussaint(points);
+	}
 
-		sort(s.begin(), s.end());
+	// Coordinates of the point in slot i
+	T X(int i) { return points.x[i]; }
+	T Y(int i) { return points.y[i]; }
+	pair<T,T> P(int i) { return points.point(i); }
 
-		cout<<"Points in "<<iterlb++<<" are : \n";
-		for (int i = 0; i < s.size(); ++i)
-		{
-			cout<<s[i].first<<" "<<s[i].second<<endl;
-		}
-		cout<<"End points \n";
+	// Slope of the line through the points in slots a and b, a left of b
+	Slope<T> slope(int a, int b) { return Slope<T>(P(a), P(b)); }
+
+	// Number of chunks the bridge loops over n items are cut into, 1 unless
+	// the parallel mode is on and n is above grain
+	int chunks(int n) { return pool && n > grain ? pool->chunks(n, grain) : 1; }
+
+	template<typename F>
+	void forChunks(int n, int count, F body)
+	{
+		if (count == 1)
+			body(0, 0, n);
+		else
+			pool->forChunks(n, count, body);
+	}
 
-		vector<pair<int,int> > cand;
+	pair<int,int> upperBridge(vector<int>s,int l,int depth=0,int round=0)
+	{
+		KPS_TRACE_EVENT(traceRing,Bridge,1,depth,round,(int)s.size());
 
+		vector<int> cand;
 	    int n = s.size();
-	    // sort(s.begin(),s.end());
 	    if(n==2)
 	    {
-	        sort(s.begin(),s.end());
-	        return make_pair(s[1],s[0]);
+	        if(P(s[1])<P(s[0]))
+	            swap(s[0],s[1]);
+	        return make_pair(s[0],s[1]);
 	    }
-
-	    vector<pair<pair<int,int>,pair<int,int>>> pairs;
-	    vector<double> k;
-	    vector< pair< double, pair< pair< int, int >,pair< int,int > > > > slope_pair;
-	    bool flag=true;
-
-	    
-	    for(int i=0;i<=n-2;i+=2)
+	    vector<pair<int,int>> pairs(n/2);
+	    vector<Slope<T> > k;
+	    vector< pair< Slope<T>, pair< int,int > > > slope_pair;
+	    int parts=chunks(n/2);
+	    forChunks(n/2,parts,[&](int c,int lo,int hi)
 	    {
-	        if(s[i].first<s[i+1].first)
-	            pairs.push_back(make_pair(s[i],s[i+1]));
-	        else
-	            pairs.push_back(make_pair(s[i+1],s[i]));
-	        if(i==n-2)
-	            flag=false;
-	    }
-	    if(flag)
+	        for(int i=lo;i<hi;i++)
+	        {
+	            if(X(s[2*i])<X(s[2*i+1]))
+	                pairs[i]=make_pair(s[2*i],s[2*i+1]);
+	            else
+	                pairs[i]=make_pair(s[2*i+1],s[2*i]);
+	        }
+	    });
+	    if(n%2)
 	        cand.push_back(s[n-1]);
-
-	    
-	    cout<<"Points in pairs : \n";
-		for (int i = 0; i < pairs.size(); ++i)
-		{
-			cout<<pairs[i].first.first<<" "<<pairs[i].first.second<<" and "<<pairs[i].second.first<<" "<<pairs[i].second.second<<endl;
-		}
-		cout<<"End points \n";
-
-	    
-	    for(int i=0;i<pairs.size();i++)
+	    // Every chunk collects its own candidates and slopes, they are joined
+	    // in chunk order so the result does not depend on the chunking
+	    vector<vector<int> > vertical(parts);
+	    vector<vector<pair<Slope<T>,pair<int,int> > > > sloped(parts);
+	    forChunks(n/2,parts,[&](int c,int lo,int hi)
 	    {
-	        if(pairs[i].first.first==pairs[i].second.first)
+	        for(int i=lo;i<hi;i++)
 	        {
-	            if(pairs[i].first.second>pairs[i].second.second)
-	                cand.push_back(pairs[i].first);
+	            if(X(pairs[i].first)==X(pairs[i].second))
+	            {
+	                if(Y(pairs[i].first)>Y(pairs[i].second))
+	                    vertical[c].push_back(pairs[i].first);
+	                else
+	                    vertical[c].push_back(pairs[i].second);
+	            }
 	            else
-	                cand.push_back(pairs[i].second);
+	                sloped[c].push_back(make_pair(slope(pairs[i].first,pairs[i].second),pairs[i]));
 	        }
-	        else
-	        {
-	            double temp=slope(pairs[i]);
-	            k.push_back(temp);
-	            slope_pair.push_back(make_pair(temp,pairs[i]));
-	        }        
-	    }
-	    
-	    
-	    sort(k.begin(),k.end());
-	    
-
-	    cout<<"Slope size and points : "<<k.size()<<endl;
-	    for (int i = 0; i < k.size(); ++i)
+	    });
+	    for(int c=0;c<parts;c++)
 	    {
-	    	cout<<k[i]<<endl;
+	        cand.insert(cand.end(),vertical[c].begin(),vertical[c].end());
+	        slope_pair.insert(slope_pair.end(),sloped[c].begin(),sloped[c].end());
 	    }
-	    double midslope;
-	    // if(k.size()%2==0)
-	    // {
-	        // midslope=(k[k.size()/2]+k[(k.size()/2)-1])/2;
-	    // }
-	    // else
-	    midslope=k[k.size()/2];
-
-	    
-	    vector<pair<pair<int,int>,pair<int,int>>> small,equal,large;
 	    for(int i=0;i<slope_pair.size();i++)
+	        k.push_back(slope_pair[i].first);
+	    // Every pair was vertical, only the upper point of each survives
+	    if(k.empty())
+	        return upperBridge(cand,l,depth,round+1);
+	    Slope<T> midslope;
+	    // Median slope in linear time, no need to sort all of k. The slopes
+	    // are fractions compared by cross multiplication, so equal slopes
+	    // really compare equal below.
+	    midslope=selectKth(k,k.size()/2,less<Slope<T> >(),deterministicSelect);
+
+	    vector<pair<int,int>> small,equal,large;
+	    partitionSlopes(slope_pair,midslope,small,equal,large);
+
+	    // Leftmost and rightmost of the points with the largest intercept on
+	    // the line of slope midslope
+	    int pmin,pmax;
+	    extremeIntercepts(s,midslope,true,pmin,pmax);
+	    if(X(pmin)<=X(l) && X(pmax)>X(l))
+	    {
+	        return make_pair(pmin,pmax);
+	    }
+	    if(X(pmax)<=X(l))
 	    {
-	        if(slope_pair[i].first<midslope)
+	        for(int i=0;i<small.size();i++)
 	        {
-	            small.push_back(slope_pair[i].second);
+	            cand.push_back(small[i].first);
+	            cand.push_back(small[i].second);
 	        }
-	        else if(slope_pair[i].first==midslope)
-	        {
-	            equal.push_back(slope_pair[i].second);
-	        } 
-	        else
+	        for(int i=0;i<large.size();i++)
 	        {
-	            large.push_back(slope_pair[i].second);
+	            cand.push_back(large[i].second);
 	        }
-	    }
-
-	    
-	    double maxval=1000; //MAXIMUM VALUE OF INTERCEPT ON NEGATIVE Y AXIS
-	    cout<<"************************\n";
-	    cout<<"Points : \n";
-	    for(int i=0;i<n;i++)
-	    {
-	    	cout<<s[i].first<<" "<<s[i].second<<" and intercept : "<<((double)s[i].second-(midslope*(double)s[i].first))<<endl;
-	        if(((double)s[i].second-(midslope*(double)s[i].first)) < maxval)
-	            maxval=(double)s[i].second-(midslope*(double)s[i].first);
-
-	    }
-	    cout<<"------------------------\n";
-	    
-
-	    cout<<"max val of intercept : "<<maxval<<endl;
-	    
-
-	    vector<pair<int,int>> maxset;
-	    pair<int,int> pmax=make_pair(INT_MIN,INT_MIN);
-	    pair<int,int> pmin=make_pair(INT_MAX,INT_MAX);
-	    
-
-	    for(int i=0;i<s.size();i++)
-	    {
-	    	cout<<"s[i] : "<<s[i].first<<" "<<s[i].second<<endl;
-	        if(maxval==((double)s[i].second-(midslope*(double)s[i].first)))
+	        for(int i=0;i<equal.size();i++)
 	        {
-	            maxset.push_back(s[i]);
-	            if(pmax.first<s[i].first)
-	            {
-	                pmax.first=s[i].first;
-	                pmax.second=s[i].second;
-	            }
-	            if(pmin.first>s[i].first)
-	            {
-	                pmin.first=s[i].first;
-	                pmin.second=s[i].second;
-	            }
+	            cand.push_back(equal[i].second);
 	        }
 	    }
-	    
-
-	    cout<<"pmin : "<<pmin.first<<" "<<pmin.second<<" and pmax : "<<pmax.first<<" "<<pmax.second<<endl;
-	    //FATAL : IF CONDITION IS SAME AS UPPER BRIDGE, SHOULD IT BE CHANGED?
-	    if(pmin.first<=l.first && pmax.first>l.first)
-	    {
-	    	cout<<"Hello\n";
-	    	cout<<"***********************************************Points returned during " << (iterlb - 1) << " iteration : "<<pmin.first<<" "<<pmin.second<<" and "<<pmax.first<<" "<<pmax.second<<endl;
-	        cout<<"Hello2\n";
-	        return make_pair(pmax,pmin);
-	    }
-	    cout<<"Yo\n";
-	    //Copied from upper bridge starts
-	    if(pmax.first<=l.first)
+	    if(X(pmin)>X(l))
 	    {
 	        for(int i=0;i<large.size();i++)
 	        {
@@ -609,51 +989,251 @@ class KirkPatrickSeidel
 	        }
 	        for(int i=0;i<small.size();i++)
 	        {
-	            cand.push_back(small[i].second);
+	            cand.push_back(small[i].first);
 	        }
 	        for(int i=0;i<equal.size();i++)
 	        {
-	            cand.push_back(equal[i].second);
+	            cand.push_back(equal[i].first);
 	        }
 	    }
-	    if(pmin.first>l.first)
-	    {
-	        for(int i=0;i<small.size();i++)
+	    return upperBridge(cand,l,depth,round+1);
+	}
+
+	// Splits the pairs by their slope against midslope, chunk by chunk
+	void partitionSlopes(vector<pair<Slope<T>,pair<int,int> > > &slope_pair, Slope<T> midslope, vector<pair<int,int> > &small, vector<pair<int,int> > &equal, vector<pair<int,int> > &large)
+	{
+	    int parts=chunks(slope_pair.size());
+	    vector<vector<pair<int,int> > > sm(parts),eq(parts),lg(parts);
+	    forChunks(slope_pair.size(),parts,[&](int c,int lo,int hi)
+	    {
+	        for(int i=lo;i<hi;i++)
 	        {
-	            cand.push_back(small[i].first);
-	            cand.push_back(small[i].second);
+	            if(slope_pair[i].first<midslope)
+	                sm[c].push_back(slope_pair[i].second);
+	            else if(slope_pair[i].first==midslope)
+	                eq[c].push_back(slope_pair[i].second);
+	            else
+	                lg[c].push_back(slope_pair[i].second);
 	        }
-	        for(int i=0;i<large.size();i++)
+	    });
+	    for(int c=0;c<parts;c++)
+	    {
+	        small.insert(small.end(),sm[c].begin(),sm[c].end());
+	        equal.insert(equal.end(),eq[c].begin(),eq[c].end());
+	        large.insert(large.end(),lg[c].begin(),lg[c].end());
+	    }
+	}
+
+	// Finds the leftmost (pmin) and rightmost (pmax) slot of s whose point has
+	// the largest intercept on the line of slope midslope, or the smallest if
+	// largest is false. Intercepts are compared through midslope, exactly.
+	void extremeIntercepts(vector<int> &s, Slope<T> midslope, bool largest, int &pmin, int &pmax)
+	{
+	    int n=s.size();
+	    int parts=chunks(n);
+	    vector<int> lo_(parts,-1),hi_(parts,-1);
+	    forChunks(n,parts,[&](int c,int lo,int hi)
+	    {
+	        for(int i=lo;i<hi;i++)
 	        {
-	            cand.push_back(large[i].first);
+	            int cmp=hi_[c]==-1 ? 0 : midslope.compareIntercepts(P(s[i]),P(hi_[c]));
+	            if(hi_[c]==-1 || (largest ? cmp>0 : cmp<0))
+	                lo_[c]=hi_[c]=s[i];
+	            else if(cmp==0)
+	            {
+	                if(X(hi_[c])<X(s[i]))
+	                    hi_[c]=s[i];
+	                if(X(lo_[c])>X(s[i]))
+	                    lo_[c]=s[i];
+	            }
 	        }
-	        for(int i=0;i<equal.size();i++)
+	    });
+	    pmin=pmax=-1;
+	    for(int c=0;c<parts;c++)
+	    {
+	        if(hi_[c]==-1)
+	            continue;
+	        int cmp=pmax==-1 ? 0 : midslope.compareIntercepts(P(hi_[c]),P(pmax));
+	        if(pmax==-1 || (largest ? cmp>0 : cmp<0))
 	        {
-	            cand.push_back(equal[i].first);
+	            pmin=lo_[c];
+	            pmax=hi_[c];
+	        }
+	        else if(cmp==0)
+	        {
+	            if(X(pmax)<X(hi_[c]))
+	                pmax=hi_[c];
+	            if(X(pmin)>X(lo_[c]))
+	                pmin=lo_[c];
 	        }
 	    }
-	    //Copied from Upper Bridge ends
-	    /*if(pmax.first<l.first)
+	}
+
+	// Splits v at the x-coordinate of x_med: tleft gets the points with
+	// x <= X(x_med), tright the others
+	void splitAt(vector<int> &v, int x_med, vector<int> &tleft, vector<int> &tright)
+	{
+	    int parts=chunks(v.size());
+	    vector<vector<int> > l(parts),r(parts);
+	    forChunks(v.size(),parts,[&](int c,int lo,int hi)
 	    {
-	        for(int i=0;i<small.size();i++)
+	        for(int i=lo;i<hi;i++)
 	        {
-	            cand.push_back(small[i].first);
-	            cand.push_back(small[i].second);
+	            if(X(v[i]) <= X(x_med))
+	                l[c].push_back(v[i]);
+	            else
+	                r[c].push_back(v[i]);
 	        }
-	        for(int i=0;i<large.size();i++)
+	    });
+	    for(int c=0;c<parts;c++)
+	    {
+	        tleft.insert(tleft.end(),l[c].begin(),l[c].end());
+	        tright.insert(tright.end(),r[c].begin(),r[c].end());
+	    }
+	}
+
+	// Appends to out the slots of t strictly between a and b in x for which
+	// isLeft(P(a),P(b),P(slot)) has the sign side
+	void keepOutside(vector<int> &t, int a, int b, int lox, int hix, int side, vector<int> &out)
+	{
+	    int parts=chunks(t.size());
+	    vector<vector<int> > kept(parts);
+	    forChunks(t.size(),parts,[&](int c,int lo,int hi)
+	    {
+	        for(int i=lo;i<hi;i++)
+	            if(isLeft(P(a),P(b),P(t[i]))*side>0 && X(t[i]) > X(lox) && X(t[i]) < X(hix))
+	                kept[c].push_back(t[i]);
+	    });
+	    for(int c=0;c<parts;c++)
+	        out.insert(out.end(),kept[c].begin(),kept[c].end());
+	}
+
+	// Runs left() and right(), as two tasks if the parallel mode is on and the
+	// subproblem has at least cutoff points
+	template<typename L, typename R>
+	void both(int n, L left, R right)
+	{
+	    if(pool && n>=cutoff)
+	    {
+	        TaskPool::Group g;
+	        pool->spawn(g,left);
+	        right();
+	        pool->wait(g);
+	    }
+	    else
+	    {
+	        left();
+	        right();
+	    }
+	}
+
+	HullList<T> upperhull(int pmin, int pmax,vector<int> v,int depth=0)
+	{
+		int n = v.size();
+		KPS_TRACE_EVENT(traceRing,Hull,1,depth,0,n);
+	    if(P(pmin) == P(pmax))
+	        return arena->make(P(pmin));
+	    // v is sorted by x and the partitions below keep it so, the median
+	    // is simply the middle slot
+	    int x_med = v[n/2];
+	    vector<int> tleft, tright;
+	    splitAt(v,x_med,tleft,tright);
+	    pair<int,int> plpr;
+	    plpr = upperBridge(v,x_med,depth);
+	    int pl=plpr.first;
+	    int pr=plpr.second;
+	    vector<int> ntleft,ntright;
+	    // Endpoints around the kept points, in x order
+	    ntleft.push_back(pmin);
+	    keepOutside(tleft,pmin,pl,pmin,pl,1,ntleft);
+	    ntleft.push_back(pl);
+	    ntright.push_back(pr);
+	    keepOutside(tright,pr,pmax,pr,pmax,1,ntright);
+	    ntright.push_back(pmax);
+	    HullList<T> left, right;
+	    both(n,[&]() { left=upperhull(pmin,pl,ntleft,depth+1); },[&]() { right=upperhull(pr,pmax,ntright,depth+1); });
+
+	    left.splice(right);
+	    return left;
+	}
+
+	pair<int,int> lowerBridge(vector<int>s,int l,int depth=0,int round=0)
+	{
+		KPS_TRACE_EVENT(traceRing,Bridge,-1,depth,round,(int)s.size());
+
+		vector<int> cand;
+
+	    int n = s.size();
+	    if(n==2)
+	    {
+	        if(P(s[1])<P(s[0]))
+	            swap(s[0],s[1]);
+	        return make_pair(s[1],s[0]);
+	    }
+
+	    vector<pair<int,int>> pairs(n/2);
+	    vector<Slope<T> > k;
+	    vector< pair< Slope<T>, pair< int,int > > > slope_pair;
+
+	    int parts=chunks(n/2);
+	    forChunks(n/2,parts,[&](int c,int lo,int hi)
+	    {
+	        for(int i=lo;i<hi;i++)
 	        {
-	            cand.push_back(large[i].first);
+	            if(X(s[2*i])<X(s[2*i+1]))
+	                pairs[i]=make_pair(s[2*i],s[2*i+1]);
+	            else
+	                pairs[i]=make_pair(s[2*i+1],s[2*i]);
 	        }
-	        for(int i=0;i<equal.size();i++)
+	    });
+	    if(n%2)
+	        cand.push_back(s[n-1]);
+	    vector<vector<int> > vertical(parts);
+	    vector<vector<pair<Slope<T>,pair<int,int> > > > sloped(parts);
+	    forChunks(n/2,parts,[&](int c,int lo,int hi)
+	    {
+	        for(int i=lo;i<hi;i++)
 	        {
-	            cand.push_back(equal[i].first);
+	            if(X(pairs[i].first)==X(pairs[i].second))
+	            {
+	                if(Y(pairs[i].first)<Y(pairs[i].second))
+	                    vertical[c].push_back(pairs[i].first);
+	                else
+	                    vertical[c].push_back(pairs[i].second);
+	            }
+	            else
+	                sloped[c].push_back(make_pair(slope(pairs[i].first,pairs[i].second),pairs[i]));
 	        }
+	    });
+	    for(int c=0;c<parts;c++)
+	    {
+	        cand.insert(cand.end(),vertical[c].begin(),vertical[c].end());
+	        slope_pair.insert(slope_pair.end(),sloped[c].begin(),sloped[c].end());
 	    }
-	    
-
-	    if(pmin.first>=l.first)
+	    for(int i=0;i<slope_pair.size();i++)
+	        k.push_back(slope_pair[i].first);
+	    // Every pair was vertical, only the lower point of each survives
+	    if(k.empty())
+	        return lowerBridge(cand,l,depth,round+1);
+	    Slope<T> midslope;
+	    // Median slope in linear time, no need to sort all of k. The slopes
+	    // are fractions compared by cross multiplication, so equal slopes
+	    // really compare equal below.
+	    midslope=selectKth(k,k.size()/2,less<Slope<T> >(),deterministicSelect);
+
+	    vector<pair<int,int>> small,equal,large;
+	    partitionSlopes(slope_pair,midslope,small,equal,large);
+
+	    // Leftmost and rightmost of the points with the smallest intercept on
+	    // the line of slope midslope
+	    int pmax,pmin;
+	    extremeIntercepts(s,midslope,false,pmin,pmax);
+	    if(X(pmin)<=X(l) && X(pmax)>X(l))
+	    {
+	        return make_pair(pmax,pmin);
+	    }
+	    if(X(pmax)<=X(l))
 	    {
-	    	cout<<"Inside right points\n";
 	        for(int i=0;i<large.size();i++)
 	        {
 	            cand.push_back(large[i].first);
@@ -667,280 +1247,1093 @@ class KirkPatrickSeidel
 	        {
 	            cand.push_back(equal[i].second);
 	        }
-	    }*/
-	    return lowerBridge(cand,l);
+	    }
+	    if(X(pmin)>X(l))
+	    {
+	        for(int i=0;i<small.size();i++)
+	        {
+	            cand.push_back(small[i].first);
+	            cand.push_back(small[i].second);
+	        }
+	        for(int i=0;i<large.size();i++)
+	        {
+	            cand.push_back(large[i].first);
+	        }
+	        for(int i=0;i<equal.size();i++)
+	        {
+	            cand.push_back(equal[i].first);
+	        }
+	    }
+	    return lowerBridge(cand,l,depth,round+1);
 	}
 
-	Node* lowerhull(pair<int,int> pmax, pair<int,int> pmin,vector<pair<int, int>> v)
+	HullList<T> lowerhull(int pmax, int pmin,vector<int> v,int depth=0)
 	{
-		iterlh++;iterlb = 1;
 	    int n = v.size();
-	    sort(v.begin(), v.end());
+	    KPS_TRACE_EVENT(traceRing,Hull,-1,depth,0,n);
+
+	    if(P(pmin) == P(pmax))
+	        return arena->make(P(pmin));
+	    // v is sorted by x and the partitions below keep it so, the median
+	    // is simply the middle slot
+	    int x_med = v[n/2];
+	    vector<int> tleft, tright;
+	    splitAt(v,x_med,tleft,tright);
+	    pair<int,int> prpl;
+	    prpl = lowerBridge(v,x_med,depth);
+	    int pr=prpl.first;
+	    int pl=prpl.second;
+	    vector<int> ntleft,ntright;
+	    // Endpoints around the kept points, in x order
+	    ntleft.push_back(pmin);
+	    keepOutside(tleft,pl,pmin,pmin,pl,1,ntleft);
+	    ntleft.push_back(pl);
+	    ntright.push_back(pr);
+	    keepOutside(tright,pr,pmax,pr,pmax,-1,ntright);
+	    ntright.push_back(pmax);
+	    HullList<T> left, right;
+	    both(n,[&]() { left=lowerhull(pmax,pr,ntright,depth+1); },[&]() { right=lowerhull(pl,pmin,ntleft,depth+1); });
 
-	    cout<<"Inside lowerhull : pmin : "<< pmin.first<<" "<<pmin.second<<" and pmax : "<<pmax.first<<" "<<pmax.second<<endl;
-	    for (int i = 0; i < v.size(); ++i)
-	    {
-	    	cout<<v[i].first<<" "<<v[i].second<<endl;
-	    }
-	    cout<<"Points end\n";
+	    left.splice(right);
+	    return left;
+	}
 
-	    if(pmin.first == pmax.first && pmin.second == pmax.second)
-	    {
-	        Node* head=(Node *)malloc(sizeof(Node));
-	        head->p.first=pmin.first;
-	        head->p.second=pmin.second;
-	        head->prev=NULL;
-	        head->next=NULL;
-	        return head;
-	    }
-	    pair<int,int> x_med;
-	    if(n%2==0)
-	        x_med= v[n/2];//make_pair((v[n/2-1].first+v[n/2].first)/2,(v[n/2-1].second+v[n/2].second)/2);
-	    else
-	        x_med = v[n/2];
-	    vector<pair<int, int> >tleft, tright;
-	    for(int i = 0;i < n; i++)
+	void kps(bool filter = false)
+	{
+		if(filter)
+			prefilter();
+
+		sorts=0;
+#ifdef KPS_TRACE
+		traceRing.clear();
+#endif
+		// There must be at least 3 points, S[0] is read below
+		if(points.size()<3)
+		{
+			writeSmallHull(points,points.size(),sink);
+			return;
+		}
+
+		// One sort of the slots by x and then y gives every extreme point and
+		// the highest and lowest point of every x, so the duplicate x are
+		// collapsed in the same pass. The coordinates stay put.
+		vector<int> ord(points.size());
+		for(int i=0;i<ord.size();i++)
+			ord[i]=i;
+		sort(ord.begin(),ord.end(),[&](int a, int b) { return comparepointslh(P(a),P(b)); });
+		sorts++;
+
+		// S and SL list the highest and the lowest point of every x, in x
+		// order, the recursion keeps them in that order
+		vector<int> S, SL;
+		for(int i=0;i<ord.size();)
+		{
+			int j=i;
+			while(j+1<ord.size() && X(ord[j+1])==X(ord[i]))
+				j++;
+			S.push_back(ord[j]);
+			SL.push_back(ord[i]);
+			i=j+1;
+		}
+		int pumin=S[0], pumax=ord.back();
+		int plmin=ord[0], plmax=SL.back();
+
+	    // The upper hull runs from pumin to pumax and the lower hull from
+	    // plmax back to plmin, so together they go round clockwise
+	    // Every node of this run comes from one arena, freed on return
+	    NodeArena<T> nodes;
+	    arena=&nodes;
+	    HullList<T> upper, lower;
+	    both(ord.size(),[&]() { upper=upperhull(pumin,pumax,S); },[&]() { lower=lowerhull(plmax,plmin,SL); });
+	    arena=NULL;
+
+	    vector<pair<T,T> > hull;
+	    upper.exportTo(hull);
+	    lower.exportTo(hull);
+	    while(hull.size()>1 && hull.back()==hull[0])
+	        hull.pop_back();
+	    // Counterclockwise from the leftmost point, like the other engines
+	    reverse(hull.begin(),hull.end());
+	    rotate(hull.begin(),min_element(hull.begin(),hull.end()),hull.end());
+	    writeHull(hull, sink);
+	}
+
+	// Parallel mode of kps(). The upper and lower hulls, and the two halves of
+	// every hull subproblem with at least cutoff points, run as tasks on a work
+	// stealing pool of the given number of threads, and the loops of the
+	// bridges are split over the pool above grain points.
+	void kpsParallel(int threads, bool filter = false)
+	{
+		TaskPool tasks(threads);
+		pool = &tasks;
+		kps(filter);
+		pool = NULL;
+	}
+
+	// Point in slot i with y negated if sg is -1. The lower hull is the upper
+	// hull of the points mirrored in the x-axis, so the in-place mode only
+	// has the upper case.
+	pair<T,T> Q(int i, int sg) { return make_pair(X(i), sg > 0 ? Y(i) : (T)-Y(i)); }
+
+	// upperBridge() on the slots work[lo,hi), which it prunes in place. Every
+	// round moves the pairs that are not vertical to the front of the range,
+	// then writes the points that can still be on the bridge back over it.
+	pair<int,int> bridgeRange(int lo, int hi, T xl, int sg, int depth)
+	{
+	    for(int round=0;;round++)
 	    {
-	        //FATAL : ADDED EQUAL CONDITION
-	        if(v[i].first <= x_med.first)
+	        int n=hi-lo;
+	        KPS_TRACE_EVENT(traceRing,Bridge,sg,depth,round,n);
+	        if(n==2)
 	        {
-	            tleft.push_back(v[i]);
+	            if(Q(work[lo+1],sg)<Q(work[lo],sg))
+	                swap(work[lo],work[lo+1]);
+	            return make_pair(work[lo],work[lo+1]);
 	        }
-	        else
+	        // Pairs left point first, the vertical ones upper point first
+	        int m=lo;
+	        for(int i=lo;i+1<hi;i+=2)
 	        {
-	            tright.push_back(v[i]);
+	            int &a=work[i], &b=work[i+1];
+	            if(X(a)==X(b))
+	            {
+	                if(Q(a,sg).second<Q(b,sg).second)
+	                    swap(a,b);
+	                continue;
+	            }
+	            if(X(b)<X(a))
+	                swap(a,b);
+	            swap(work[m],a);
+	            swap(work[m+1],b);
+	            m+=2;
 	        }
-	    }
+	        int k=(m-lo)/2;
+	        for(int i=0;i<k;i++)
+	            slopes[i]=Slope<T>(Q(work[lo+2*i],sg),Q(work[lo+2*i+1],sg));
 
-	    cout<<"Median : "<<x_med.first<<" "<<x_med.second<<endl;
+	        // Every pair was vertical, only the upper point of each survives
+	        int w=lo;
+	        if(k==0)
+	        {
+	            for(int i=lo;i<hi;i+=2)
+	                work[w++]=work[i];
+	            hi=w;
+	            continue;
+	        }
+	        Slope<T> midslope=selectRange(slopes,0,k,k/2,less<Slope<T> >(),deterministicSelect);
 
-	    cout<<"tleft points : "<<endl;
-	    for (int i = 0; i < tleft.size(); ++i)
-	    {
-	    	cout<<tleft[i].first<<" "<<tleft[i].second<<endl;
+	        // Leftmost and rightmost of the points with the largest intercept
+	        int pmin=-1,pmax=-1;
+	        for(int i=lo;i<hi;i++)
+	        {
+	            int cmp=pmin==-1 ? 0 : midslope.compareIntercepts(Q(work[i],sg),Q(pmin,sg));
+	            if(pmin==-1 || cmp>0)
+	                pmin=pmax=work[i];
+	            else if(cmp==0)
+	            {
+	                if(X(work[i])<X(pmin))
+	                    pmin=work[i];
+	                if(X(work[i])>X(pmax))
+	                    pmax=work[i];
+	            }
+	        }
+	        if(X(pmin)<=xl && X(pmax)>xl)
+	            return make_pair(pmin,pmax);
+
+	        // Same pruning as upperBridge(), written back over the range. The
+	        // write position never passes the read position.
+	        bool right=X(pmax)<=xl;
+	        for(int i=lo;i<m;i+=2)
+	        {
+	            int a=work[i], b=work[i+1];
+	            Slope<T> sl(Q(a,sg),Q(b,sg));
+	            if(right ? sl<midslope : midslope<sl)
+	            {
+	                work[w++]=a;
+	                work[w++]=b;
+	            }
+	            else
+	                work[w++]=right ? b : a;
+	        }
+	        for(int i=m;i<hi;i+=2)
+	            work[w++]=work[i];
+	        hi=w;
 	    }
+	}
 
-	    cout<<"tright points : "<<endl;
-	    for (int i = 0; i < tright.size(); ++i)
+	// upperhull() on the slots buf[lo,hi), which hold pmin, pmax and the
+	// points strictly between them in x and above the line through them.
+	// The range is partitioned in place into the two subproblems and the
+	// hull slots are appended to chain from left to right.
+	void hullRange(int lo, int hi, int pmin, int pmax, int sg, int depth=0)
+	{
+	    KPS_TRACE_EVENT(traceRing,Hull,sg,depth,0,hi-lo);
+	    if(P(pmin)==P(pmax))
 	    {
-	    	cout<<tright[i].first<<" "<<tright[i].second<<endl;
+	        chain.push_back(pmin);
+	        return;
 	    }
-	    cout<<"tleft and tright end\n";
+	    int mid=lo+(hi-lo)/2;
+	    T xl=X(selectRange(buf,lo,hi,mid,[&](int a, int b) { return P(a)<P(b); },deterministicSelect));
+	    copy(buf.begin()+lo,buf.begin()+hi,work.begin()+lo);
+	    pair<int,int> br=bridgeRange(lo,hi,xl,sg,depth);
+	    int pl=br.first, pr=br.second;
+
+	    auto above=[&](int a, int b, int e) { return X(e)>X(a) && X(e)<X(b) && isLeft(Q(a,sg),Q(b,sg),Q(e,sg))>0; };
+	    int m=partition(buf.begin()+lo,buf.begin()+hi,[&](int e) { return e==pmin || e==pl || above(pmin,pl,e); })-buf.begin();
+	    int end=partition(buf.begin()+m,buf.begin()+hi,[&](int e) { return e==pr || e==pmax || above(pr,pmax,e); })-buf.begin();
+	    hullRange(lo,m,pmin,pl,sg,depth+1);
+	    hullRange(m,end,pr,pmax,sg,depth+1);
+	}
 
+	// Allocation free mode of kps(). The bridges and the recursion work on
+	// index ranges of buffers sized once to the number of points, the
+	// candidates are pruned by compacting them in place and the split at the
+	// median is a partition. No sort is needed either: the endpoints of a
+	// half are its leftmost and rightmost points and the points that are not
+	// above the line through them are dropped up front.
+	void kpsInPlace(bool filter = false)
+	{
+		if(filter)
+			prefilter();
+
+		sorts=0;
+#ifdef KPS_TRACE
+		traceRing.clear();
+#endif
+		int n=points.size();
+		// There must be at least 3 points
+		if(n<3)
+		{
+			writeSmallHull(points,n,sink);
+			return;
+		}
+		buf.resize(n);
+		work.resize(n);
+		slopes.resize(n/2+1);
+		chain.reserve(n);
+
+		// Lower chain left to right, then the upper chain right to left
+		vector<pair<T,T> > hull;
+		for(int sg=-1;sg<=1;sg+=2)
+		{
+			int pmin=0,pmax=0;
+			for(int i=1;i<n;i++)
+			{
+				if(X(i)<X(pmin) || (X(i)==X(pmin) && Q(i,sg).second>Q(pmin,sg).second))
+					pmin=i;
+				if(X(i)>X(pmax) || (X(i)==X(pmax) && Q(i,sg).second>Q(pmax,sg).second))
+					pmax=i;
+			}
+			int size=0;
+			buf[size++]=pmin;
+			if(pmax!=pmin)
+				buf[size++]=pmax;
+			for(int i=0;i<n;i++)
+				if(X(i)>X(pmin) && X(i)<X(pmax) && isLeft(Q(pmin,sg),Q(pmax,sg),Q(i,sg))>0)
+					buf[size++]=i;
+			chain.clear();
+			hullRange(0,size,pmin,pmax,sg);
+			if(sg>0)
+				reverse(chain.begin(),chain.end());
+			for(int i=0;i<chain.size();i++)
+				if(hull.empty() || hull.back()!=P(chain[i]))
+					hull.push_back(P(chain[i]));
+		}
+		while(hull.size()>1 && hull.back()==hull[0])
+			hull.pop_back();
+		writeHull(hull, sink);
+	}
 
-	    pair<pair<int, int>, pair<int, int> > prpl;
-	    prpl = lowerBridge(v, x_med);
+	~KirkPatrickSeidel(){}
+	
+};
 
+//Upper hull of a point set, x -> y, left to right with strict right turns.
+//The lower hull is the upper hull of the points mirrored in the x-axis.
+//insert() is O(log h) plus the vertices it removes, each of which was added
+//once. With logging on every insert() can be taken back by undo(), latest
+//first, in the time of the vertices it removed.
+template<typename T>
+struct UpperChain
+{
+    map<T,T> pts;
+    bool logging = false;
+
+    typedef typename map<T,T>::iterator It;
+
+    static pair<T,T> P(It it) { return make_pair(it->first, it->second); }
+
+    bool insert(T x, T y)
+    {
+        pair<T,T> p = make_pair(x, y);
+        if (logging)
+            frames.push_back(Frame{false, x, (int)removed.size()});
+        It next = pts.lower_bound(x);
+        if (next != pts.end() && next->first == x)
+        {
+            if (y <= next->second)
+                return false;
+            drop(next++);
+        }
+        else if (next != pts.end() && next != pts.begin())
+        {
+            // Strictly between two vertices, inside unless above their edge
+            It prev = prev_(next);
+            if (isLeft(P(prev), P(next), p) <= 0)
+                return false;
+        }
+        It at = pts.insert(next, p);
+        if (logging)
+            frames.back().added = true;
+
+        // Cut the chain back on both sides until it turns right again
+        while (at != pts.begin())
+        {
+            It a = prev_(at);
+            if (a == pts.begin() || isLeft(P(prev_(a)), P(a), p) < 0)
+                break;
+            drop(a);
+        }
+        while (true)
+        {
+            It b = next_(at);
+            if (b == pts.end() || next_(b) == pts.end() || isLeft(p, P(b), P(next_(b))) < 0)
+                break;
+            drop(b);
+        }
+        return true;
+    }
+
+    // Takes back the latest insert() that is not undone yet
+    void undo()
+    {
+        Frame f = frames.back();
+        frames.pop_back();
+        if (f.added)
+            pts.erase(f.x);
+        for (int i = f.from; i < removed.size(); i++)
+            pts.insert(removed[i]);
+        removed.resize(f.from);
+    }
+
+    // Number of insert() calls that undo() can take back
+    int depth() { return frames.size(); }
+
+    void clear()
+    {
+        pts.clear();
+        frames.clear();
+        removed.clear();
+    }
+
+private:
+
+    // One insert(): whether x was added and where its removed vertices start
+    struct Frame
+    {
+        bool added;
+        T x;
+        int from;
+    };
+
+    vector<Frame> frames;
+    vector<pair<T,T> > removed;
+
+    void drop(It it)
+    {
+        if (logging)
+            removed.push_back(P(it));
+        pts.erase(it);
+    }
+
+    static It prev_(It it) { return --it; }
+    static It next_(It it) { return ++it; }
+};
 
-	    pair<int,int> pr=prpl.first;
-	    pair<int,int> pl=prpl.second;
+//Writes into hull the vertices counterclockwise from the lowest of the
+//leftmost points, given the upper chain and the mirrored lower chain of the
+//points, both left to right
+template<typename T>
+void joinChains(const vector<pair<T,T> > &lower, const vector<pair<T,T> > &upper, vector<pair<T,T> > &hull)
+{
+    hull.clear();
+    for (int i = 0; i < lower.size(); i++)
+        hull.push_back(make_pair(lower[i].first, (T)-lower[i].second));
+    for (int i = (int)upper.size() - 1; i >= 0; i--)
+        if (hull.empty() || hull.back() != upper[i])
+            hull.push_back(upper[i]);
+    while (hull.size() > 1 && hull.back() == hull[0])
+        hull.pop_back();
+}
+
+template<typename T = int>
+class IncrementalHull
+{
+public:
 
+	//Where the hull goes, NULL for the default output of writeHull()
+	HullSink<T> *sink;
 
+	IncrementalHull()
+	{
+		sink=NULL;
+	}
 
-	    cout<<"pr : "<<pr.first<<" "<<pr.second<<endl;
-	    cout<<"pl : "<<pl.first<<" "<<pl.second<<endl;
+	IncrementalHull(const vector<pair<T,T> > &p) : IncrementalHull()
+	{
+		for (int i = 0; i < p.size(); i++)
+			insert(p[i]);
+	}
+
+	// Adds p, O(log h) plus the vertices it removes, each of which was added
+	// once, so O(log n) amortized. Returns false if p was already inside or on
+	// the hull, which then does not change.
+	bool insert(pair<T,T> p)
+	{
+	    bool upperChanged = upper.insert(p.first, p.second);
+	    bool lowerChanged = lower.insert(p.first, (T)-p.second);
+	    return upperChanged || lowerChanged;
+	}
+
+	// Number of vertices of the current hull, O(h)
+	int size()
+	{
+	    return snapshot().size();
+	}
+
+	// The current hull in the format of the batch engines: its vertices
+	// counterclockwise from the lowest of the leftmost points, points inside
+	// an edge left out
+	vector<pair<T,T> > snapshot()
+	{
+	    vector<pair<T,T> > hull;
+	    joinChains(vector<pair<T,T> >(lower.pts.begin(), lower.pts.end()),
+	               vector<pair<T,T> >(upper.pts.begin(), upper.pts.end()), hull);
+	    return hull;
+	}
 
+	// Writes the current hull like the convexHull() of the batch engines
+	void convexHull()
+	{
+	    writeHull(snapshot(), sink);
+	}
 
+	~IncrementalHull(){};
 
-	    vector<pair<int,int>> ntleft,ntright;
+private:
 
+	UpperChain<T> upper, lower;
+};
 
+//Fully dynamic hull after Overmars and van Leeuwen. The distinct points are
+//the leaves of a weight balanced tree in (x, y) order, and every internal
+//node keeps the bridges of the upper and lower hulls of its two subtrees,
+//which is all that is needed to walk the hull of any subtree. An update
+//finds the bridges again on its path, O(log^2 n) each, and rebuilds the
+//highest subtree that got out of balance, so O(log^3 n) amortized. Every
+//leaf is also threaded to the next vertex on both sides of the whole hull,
+//so that reading the hull is O(h); an update rethreads the leaves whose
+//bridges it changed, O(log n) each.
+template<typename T = int>
+class DynamicHull
+{
+public:
 
+	//Where the hull goes, NULL for the default output of writeHull()
+	HullSink<T> *sink;
 
-	    ntleft.push_back(pl);
-	    ntleft.push_back(pmin);
-	    ntright.push_back(pr);
-	    ntright.push_back(pmax);cout<<"pmax : "<<pmax.first<<" "<<pmax.second<<endl;
+	DynamicHull()
+	{
+		sink=NULL;
+		root=-1;
+		dirty=false;
+	}
+
+	DynamicHull(const vector<pair<T,T> > &p) : DynamicHull()
+	{
+		vector<pair<T,T> > v(p);
+		sort(v.begin(), v.end());
+		vector<int> leaves;
+		for (int i = 0; i < v.size(); i++)
+			if (i > 0 && v[i] == v[i-1])
+			{
+				nodes[leaves.back()].count++;
+				total++;
+			}
+			else
+				leaves.push_back(leaf(v[i]));
+		if (!leaves.empty())
+			root = build(leaves, 0, leaves.size());
+		relink();
+		dirty = true;
+	}
+
+	// Adds p, which may already be there: every copy has to be erased
+	// before the point leaves the hull
+	void insert(pair<T,T> p)
+	{
+	    if (root < 0)
+	        root = leaf(p);
+	    else
+	        root = insert(root, p);
+	    relink();
+	    dirty = true;
+	}
+
+	// Removes one copy of p, false if there was none
+	bool erase(pair<T,T> p)
+	{
+	    if (root < 0)
+	        return false;
+	    bool found = false;
+	    root = erase(root, p, found);
+	    relink();
+	    dirty |= found;
+	    return found;
+	}
+
+	// Number of points, copies included
+	int size()
+	{
+	    return total;
+	}
 
-	    cout<<"ntright points : -----------------------------"<<endl;
-	    for (int i = 0; i < ntright.size(); ++i)
+	// The current hull in the format of the batch engines: its vertices
+	// counterclockwise from the lowest of the leftmost points, points inside
+	// an edge left out. Both chains are read off the threaded leaves in O(h),
+	// the result is kept until the next update.
+	const vector<pair<T,T> > &snapshot()
+	{
+	    if (!dirty)
+	        return hull;
+	    dirty = false;
+	    hull.clear();
+	    if (root < 0)
+	        return hull;
+	    vector<pair<T,T> > upper;
+	    for (int v = first; v >= 0; v = nodes[v].next[LOWER])
+	        hull.push_back(nodes[v].lo);
+	    for (int v = first; v >= 0; v = nodes[v].next[UPPER])
+	        upper.push_back(nodes[v].lo);
+	    for (int i = (int)upper.size() - 1; i >= 0; i--)
+	        if (hull.back() != upper[i])
+	            hull.push_back(upper[i]);
+	    while (hull.size() > 1 && hull.back() == hull[0])
+	        hull.pop_back();
+	    return hull;
+	}
+
+	// Writes the current hull like the convexHull() of the batch engines
+	void convexHull()
+	{
+	    writeHull(snapshot(), sink);
+	}
+
+	~DynamicHull(){};
+
+private:
+
+	enum { UPPER = 0, LOWER = 1 };
+
+	// A leaf is a distinct point with its number of copies, an internal node
+	// covers the points lo..hi of its subtree and keeps bridge[side], the
+	// edge of that side's hull that joins its two children. A leaf keeps in
+	// next[side] the leaf that follows it on that side of the whole hull, -1
+	// for the rightmost one, which is only meaningful while it is on the hull.
+	struct Node
+	{
+	    int left, right, size, count;
+	    pair<T,T> lo, hi;
+	    pair<T,T> bridge[2][2];
+	    int next[2];
+	};
+
+	vector<Node> nodes;
+	vector<int> freeNodes;
+	int root, total = 0;
+	// Leftmost leaf, and the points whose next[] the running update may
+	// have changed
+	int first = -1;
+	vector<pair<T,T> > touched;
+	vector<pair<T,T> > hull;
+	bool dirty;
+
+	// The lower hull is the upper hull upside down, without changing the
+	// order of the points
+	static int turn(int side, pair<T,T> a, pair<T,T> b, pair<T,T> c)
+	{
+	    int o = isLeft(a, b, c);
+	    return side == UPPER ? o : -o;
+	}
+
+	int alloc()
+	{
+	    if (freeNodes.empty())
 	    {
-	    	cout<<ntright[i].first<<" "<<ntright[i].second<<endl;
+	        nodes.push_back(Node());
+	        return nodes.size() - 1;
 	    }
+	    int v = freeNodes.back();
+	    freeNodes.pop_back();
+	    return v;
+	}
 
-	    for(int i=0;i<tleft.size();i++)
+	int leaf(pair<T,T> p)
+	{
+	    int v = alloc();
+	    Node &n = nodes[v];
+	    n.left = n.right = -1;
+	    n.size = n.count = 1;
+	    n.lo = n.hi = p;
+	    n.next[UPPER] = n.next[LOWER] = -1;
+	    touched.push_back(p);
+	    total++;
+	    return v;
+	}
+
+	int join(int l, int r)
+	{
+	    int v = alloc();
+	    nodes[v].left = l;
+	    nodes[v].right = r;
+	    pull(v);
+	    return v;
+	}
+
+	// Vertex of the side hull of subtree b where the tangent from p, a point
+	// left of all of b, touches it; the farthest one if several do
+	pair<T,T> tangent(pair<T,T> p, int b, int side)
+	{
+	    while (nodes[b].left >= 0)
 	    {
-	        if(isLeft(pl,pmin,tleft[i])>0 && tleft[i].first > pmin.first && tleft[i].first < pl.first)
-	        {
-	            ntleft.push_back(tleft[i]);
-	        }        
+	        Node &n = nodes[b];
+	        b = turn(side, p, n.bridge[side][0], n.bridge[side][1]) >= 0 ? n.right : n.left;
 	    }
-	    for(int i=0;i<tright.size();i++)
+	    return nodes[b].lo;
+	}
+
+	// Recomputes size, range and bridges of v from its children. The left
+	// end of the bridge is searched in the left child: it is at or right of
+	// the right end of a node's own bridge exactly when that end lies above
+	// the tangent from the left one. Ties go to the nearer vertices so that
+	// points inside an edge are left out.
+	void pull(int v)
+	{
+	    Node &n = nodes[v];
+	    n.size = nodes[n.left].size + nodes[n.right].size;
+	    n.lo = nodes[n.left].lo;
+	    n.hi = nodes[n.right].hi;
+	    for (int side = UPPER; side <= LOWER; side++)
 	    {
-	        if(isLeft(pr,pmax,tright[i])<0 && tright[i].first > pr.first && tright[i].first < pmax.first)
+	        int a = n.left;
+	        while (nodes[a].left >= 0)
 	        {
-	            ntright.push_back(tright[i]);
-	        }        
+	            Node &m = nodes[a];
+	            pair<T,T> t = tangent(m.bridge[side][0], n.right, side);
+	            a = turn(side, m.bridge[side][0], t, m.bridge[side][1]) > 0 ? m.right : m.left;
+	        }
+	        n.bridge[side][0] = nodes[a].lo;
+	        n.bridge[side][1] = tangent(nodes[a].lo, n.right, side);
+	        touched.push_back(n.bridge[side][0]);
 	    }
+	}
 
+	// Weight balance, a child may hold up to three quarters of the points
+	bool unbalanced(int v)
+	{
+	    Node &n = nodes[v];
+	    return 4 * max(nodes[n.left].size, nodes[n.right].size) > 3 * n.size + 4;
+	}
 
-
-
-
-
-	    cout<<"ntright points : "<<endl;
-	    for (int i = 0; i < ntright.size(); ++i)
+	void collect(int v, vector<int> &leaves)
+	{
+	    if (nodes[v].left < 0)
 	    {
-	    	cout<<ntright[i].first<<" "<<ntright[i].second<<endl;
+	        leaves.push_back(v);
+	        return;
 	    }
+	    collect(nodes[v].left, leaves);
+	    collect(nodes[v].right, leaves);
+	    freeNodes.push_back(v);
+	}
 
+	int build(const vector<int> &leaves, int lo, int hi)
+	{
+	    if (hi - lo == 1)
+	        return leaves[lo];
+	    int mid = (lo + hi) / 2;
+	    return join(build(leaves, lo, mid), build(leaves, mid, hi));
+	}
 
+	// A bridge that moves away from a point can change its thread too
+	void untouch(int v)
+	{
+	    touched.push_back(nodes[v].bridge[UPPER][0]);
+	    touched.push_back(nodes[v].bridge[LOWER][0]);
+	}
 
+	int rebalance(int v)
+	{
+	    untouch(v);
+	    pull(v);
+	    if (!unbalanced(v))
+	        return v;
+	    vector<int> leaves;
+	    collect(v, leaves);
+	    for (int i = 0; i < leaves.size(); i++)
+	        touched.push_back(nodes[leaves[i]].lo);
+	    return build(leaves, 0, leaves.size());
+	}
 
-	    Node* left=lowerhull(pmax,pr,ntright);
+	int insert(int v, pair<T,T> p)
+	{
+	    Node &n = nodes[v];
+	    if (n.left < 0)
+	    {
+	        if (n.lo == p)
+	        {
+	            n.count++;
+	            total++;
+	            return v;
+	        }
+	        int w = leaf(p);
+	        return p < nodes[v].lo ? join(w, v) : join(v, w);
+	    }
+	    if (p <= nodes[n.left].hi)
+	    {
+	        int l = insert(n.left, p);
+	        nodes[v].left = l;
+	    }
+	    else
+	    {
+	        int r = insert(n.right, p);
+	        nodes[v].right = r;
+	    }
+	    return rebalance(v);
+	}
 
+	// Returns the new root of the subtree, -1 once its last point is gone
+	int erase(int v, pair<T,T> p, bool &found)
+	{
+	    Node &n = nodes[v];
+	    if (n.left < 0)
+	    {
+	        if (n.lo != p)
+	            return v;
+	        found = true;
+	        total--;
+	        if (--n.count > 0)
+	            return v;
+	        freeNodes.push_back(v);
+	        return -1;
+	    }
+	    bool goLeft = p <= nodes[n.left].hi;
+	    int c = erase(goLeft ? n.left : n.right, p, found);
+	    if (!found)
+	        return v;
+	    if (c < 0)
+	    {
+	        // v is left with one child, which takes its place
+	        int other = goLeft ? nodes[v].right : nodes[v].left;
+	        untouch(v);
+	        freeNodes.push_back(v);
+	        return other;
+	    }
+	    if (goLeft)
+	        nodes[v].left = c;
+	    else
+	        nodes[v].right = c;
+	    return rebalance(v);
+	}
 
+	// Leaf of p below v
+	int find(int v, pair<T,T> p)
+	{
+	    while (nodes[v].left >= 0)
+	        v = p <= nodes[nodes[v].left].hi ? nodes[v].left : nodes[v].right;
+	    return v;
+	}
 
+	// The hull edge that leaves a vertex p is the bridge of the highest node
+	// whose bridge starts at p, the one of the lowest common ancestor of its
+	// two ends. Sets next[] of the leaf of p from it, if p is still there.
+	void thread(pair<T,T> p)
+	{
+	    int a[2] = {-1, -1};
+	    int v = root;
+	    while (nodes[v].left >= 0)
+	    {
+	        for (int side = UPPER; side <= LOWER; side++)
+	            if (a[side] < 0 && nodes[v].bridge[side][0] == p)
+	                a[side] = v;
+	        v = p <= nodes[nodes[v].left].hi ? nodes[v].left : nodes[v].right;
+	    }
+	    if (nodes[v].lo != p)
+	        return;
+	    for (int side = UPPER; side <= LOWER; side++)
+	        nodes[v].next[side] = a[side] < 0 ? -1 : find(nodes[a[side]].right, nodes[a[side]].bridge[side][1]);
+	}
 
-	    cout<<"ntleft points : "<<endl;
-	    for (int i = 0; i < ntleft.size(); ++i)
+	// Rethreads the touched points after an update, O(log n) each
+	void relink()
+	{
+	    if (root >= 0)
 	    {
-	    	cout<<ntleft[i].first<<" "<<ntleft[i].second<<endl;
+	        for (int i = 0; i < touched.size(); i++)
+	            thread(touched[i]);
+	        first = find(root, nodes[root].lo);
 	    }
-	    cout<<"Points end\n";
+	    touched.clear();
+	}
+};
 
+//Hull of the latest points of a stream: at most maxPoints of them and none
+//older than maxAge. The window is cut into two blocks. New points go into the
+//back block, an incremental hull. The front block holds the older points as
+//an incremental hull built from the newest to the oldest one, so expiring its
+//oldest point is undoing the last insert. When the front block runs out the
+//back block becomes the new front. Every point is inserted twice and undone
+//once, O(log W) amortized, and a query merges the two hulls in O(h).
+template<typename T = int>
+class SlidingHull
+{
+public:
+
+	//Where the hull goes, NULL for the default output of writeHull()
+	HullSink<T> *sink;
 
+	SlidingHull(int maxPoints, double maxAge = numeric_limits<double>::infinity())
+	    : maxPoints(maxPoints), maxAge(maxAge)
+	{
+		sink=NULL;
+		frontSize=0;
+		dirty=false;
+		frontUpper.logging = frontLower.logging = true;
+	}
 
+	// Adds p, which arrived at time, and expires what falls out of the window.
+	// Times must not decrease.
+	void push(pair<T,T> p, double time = 0)
+	{
+	    window.push_back(Item{p, time});
+	    backUpper.insert(p.first, p.second);
+	    backLower.insert(p.first, (T)-p.second);
+	    while (window.size() > maxPoints || window.front().time < time - maxAge)
+	        popOldest();
+	    dirty = true;
+	}
 
-	    Node* right=lowerhull(pl,pmin,ntleft);
+	// Number of points in the window
+	int size()
+	{
+	    return window.size();
+	}
 
+	// The hull of the window in the format of the batch engines, kept until
+	// the next push()
+	const vector<pair<T,T> > &snapshot()
+	{
+	    if (!dirty)
+	        return hull;
+	    dirty = false;
+	    merge(frontLower, backLower, lower);
+	    merge(frontUpper, backUpper, upper);
+	    joinChains(lower, upper, hull);
+	    return hull;
+	}
 
+	// Writes the hull of the window like the convexHull() of the batch engines
+	void convexHull()
+	{
+	    writeHull(snapshot(), sink);
+	}
 
+	~SlidingHull(){};
 
-	    if(left == NULL) {
-	        left = right;
-	        return left;
-	    }
+private:
 
-	    Node* temp=left;
-	    while(temp->next)
+	struct Item
+	{
+	    pair<T,T> p;
+	    double time;
+	};
+
+	int maxPoints;
+	double maxAge;
+	// Oldest first, the first frontSize items are the front block
+	deque<Item> window;
+	int frontSize;
+	UpperChain<T> frontUpper, frontLower, backUpper, backLower;
+	vector<pair<T,T> > lower, upper, hull;
+	bool dirty;
+
+	void popOldest()
+	{
+	    if (frontSize == 0)
 	    {
-	        temp=temp->next;
+	        // Everything is in the back block, it becomes the front one
+	        frontUpper.clear();
+	        frontLower.clear();
+	        for (int i = (int)window.size() - 1; i >= 0; i--)
+	        {
+	            frontUpper.insert(window[i].p.first, window[i].p.second);
+	            frontLower.insert(window[i].p.first, (T)-window[i].p.second);
+	        }
+	        frontSize = window.size();
+	        backUpper.clear();
+	        backLower.clear();
 	    }
-	    temp->next=right;
-	    
-	    return left;
+	    frontUpper.undo();
+	    frontLower.undo();
+	    frontSize--;
+	    window.pop_front();
 	}
 
-	void kps()
+	// Upper chain of the vertices of both chains, a linear merge followed by
+	// a monotone chain pass
+	static void merge(UpperChain<T> &a, UpperChain<T> &b, vector<pair<T,T> > &out)
 	{
-		sort(points.begin(),points.end(),comparepointsuh);
-	    pair<int,int> pumin=points[0];
-
-	    sort(points.begin(),points.end(),comparepointslh);    
-	    pair<int,int> pumax=points[points.size()-1];
-
-	    sort(points.begin(),points.end(),comparepointsuh);
-	    
-	    vector<pair<int,int>> T;
-	    T.push_back(pumin);
-	    T.push_back(pumax);
-	    
-	    vector<pair<int,int>> sol;
-	    pair<int,int> pfirst=points[0];
-	    sol.push_back(points[0]);
-	    for(int i=1;i<points.size();i++)
+	    out.clear();
+	    auto i = a.pts.begin(), j = b.pts.begin();
+	    while (i != a.pts.end() || j != b.pts.end())
 	    {
-	        int countstep=0;
-	        if(pfirst.first==points[i].first)
-	        {
-	            countstep++;
-	        }//temp->next->p.first+" "+temp->next->p.first
+	        pair<T,T> p;
+	        if (j == b.pts.end() || (i != a.pts.end() && i->first < j->first))
+	            p = *i++;
+	        else if (i == a.pts.end() || j->first < i->first)
+	            p = *j++;
 	        else
 	        {
-	            sol.push_back(points[i-countstep]);
-	            pfirst=points[i];
+	            p = make_pair(i->first, max(i->second, j->second));
+	            i++;
+	            j++;
 	        }
+	        while (out.size() >= 2 && isLeft(out[out.size()-2], out.back(), p) >= 0)
+	            out.pop_back();
+	        out.push_back(p);
 	    }
-	    for(int i=0;i<sol.size();i++)
+	}
+};
+
+//Hulls of many small point sets in one call, without an engine per set. The
+//sets are cut into chunks for the pool and every chunk hulls its sets with
+//the monotone chain in a scratch arena of its own, which is kept between
+//calls, so a steady stream of batches does not allocate. The hulls of a chunk
+//are appended to its arena and copied into the one output buffer once the
+//offsets are known.
+template<typename T = int>
+class BatchHull
+{
+public:
+
+	BatchHull(int threads = thread::hardware_concurrency()) : pool(threads)
+	{
+	}
+
+	// coords holds x0 y0 x1 y1 ..., set s being the points offsets[s] to
+	// offsets[s+1]-1 for s < sets. The hull of set s, in the format of the
+	// batch engines, goes to hull as the points hullOffsets[s] to
+	// hullOffsets[s+1]-1, with the coordinates interleaved like in coords.
+	void run(const T *coords, const int *offsets, int sets, vector<T> &hull, vector<int> &hullOffsets)
+	{
+	    hullOffsets.assign(sets + 1, 0);
+	    int count = pool.chunks(sets, 64);
+	    if (arenas.size() < count)
+	        arenas.resize(count);
+	    pool.forChunks(sets, count, [&](int c, int lo, int hi)
+	    {
+	        Arena &a = arenas[c];
+	        a.out.clear();
+	        for (int s = lo; s < hi; s++)
+	            hullOffsets[s + 1] = hullOf(coords + 2 * (long long)offsets[s], offsets[s + 1] - offsets[s], a);
+	    });
+	    for (int s = 0; s < sets; s++)
+	        hullOffsets[s + 1] += hullOffsets[s];
+	    hull.resize(2 * (size_t)hullOffsets[sets]);
+	    pool.forChunks(sets, count, [&](int c, int lo, int hi)
 	    {
-	        if(sol[i].first>pumin.first && sol[i].first<pumax.first)
+	        copy(arenas[c].out.begin(), arenas[c].out.end(), hull.begin() + 2 * (size_t)hullOffsets[lo]);
+	    });
+	}
+
+	// Same with the sets as vectors of points, for callers that have them so
+	void run(const vector<vector<pair<T,T> > > &sets, vector<T> &hull, vector<int> &hullOffsets)
+	{
+	    vector<T> coords;
+	    vector<int> offsets(1, 0);
+	    for (int s = 0; s < sets.size(); s++)
+	    {
+	        for (int i = 0; i < sets[s].size(); i++)
 	        {
-	            T.push_back(sol[i]);
+	            coords.push_back(sets[s][i].first);
+	            coords.push_back(sets[s][i].second);
 	        }
+	        offsets.push_back(offsets.back() + sets[s].size());
 	    }
-	    // Node* temp = upperhull(pumin,pumax,T);
-	    // Node* temp1=temp;
-	    ofstream fileout;
-	    fileout.open("testpoints.txt");
-	    // cout<<"\nUpper Hull : \n";
-	    // while(temp->next)
-	    // {
-	    // 	cout<<temp->p.first<<" "<<temp->p.second<<endl;
-	    // 	fileout<< to_string(temp->p.first)<<" "<<to_string(temp->p.second)<<" "<<to_string(temp->next->p.first)<<" "<<to_string(temp->next->p.second)<<" 1\n";
-	    //     temp=temp->next;
-	    // }
-	    // cout<<temp->p.first<<" "<<temp->p.second<<endl;
-	    // fileout<<to_string(temp->p.first)<<" "<<to_string(temp->p.second)<<" ";
+	    run(coords.data(), offsets.data(), sets.size(), hull, hullOffsets);
+	}
 
-	    sort(points.begin(),points.end(),comparepointslh);
-	    pair<int,int> plmin=points[0];
-	    sort(points.begin(),points.end(),comparepointsuh);    
-	    pair<int,int> plmax=points[points.size()-1];
-	    sort(points.begin(),points.end(),comparepointslh);
+	~BatchHull(){}
 
-	    T.clear();
-	    T.push_back(plmin);
-	    T.push_back(plmax);
-	    sol.clear();
-	    pfirst=points[0];
-	    sol.push_back(points[0]);
-	    for(int i=1;i<points.size();i++)
+private:
+
+	struct Arena
+	{
+	    vector<T> xs, ys;
+	    vector<char> keep;
+	    vector<unsigned long long> keys;
+	    vector<pair<T,T> > pts, chain;
+	    vector<T> out;
+	};
+
+	TaskPool pool;
+	vector<Arena> arenas;
+
+	// Appends the hull of the n points at c to a.out, returns its size
+	int hullOf(const T *c, int n, Arena &a)
+	{
+	    // Only the points outside the Akl-Toussaint octagon get sorted
+	    a.xs.resize(n);
+	    a.ys.resize(n);
+	    a.keep.assign(n, 1);
+	    for (int i = 0; i < n; i++)
 	    {
-	        int countstep=0;
-	        if(pfirst.first==points[i].first)
-	        {
-	            countstep++;
-	        }
-	        else
-	        {
-	            sol.push_back(points[i-countstep]);
-	            pfirst=points[i];
-	        }
+	        a.xs[i] = c[2*i];
+	        a.ys[i] = c[2*i+1];
 	    }
-	    for(int i=0;i<sol.size();i++)
+	    aklToussaintMark(a.xs.data(), a.ys.data(), n, a.keep.data());
+	    int m = 0;
+	    if constexpr (is_same<T,int>::value)
 	    {
-	        if(sol[i].first>plmin.first && sol[i].first<plmax.first)
-	        {
-	            T.push_back(sol[i]);
-	        }
+	        // Packed keys like PointSet::sortByX
+	        a.keys.resize(n);
+	        for (int i = 0; i < n; i++)
+	            if (a.keep[i])
+	                a.keys[m++] = ((unsigned long long)((unsigned)a.xs[i] ^ 0x80000000u) << 32) | ((unsigned)a.ys[i] ^ 0x80000000u);
+	        sort(a.keys.begin(), a.keys.begin() + m);
+	        a.pts.resize(m);
+	        for (int i = 0; i < m; i++)
+	            a.pts[i] = make_pair((int)((unsigned)(a.keys[i] >> 32) ^ 0x80000000u), (int)((unsigned)a.keys[i] ^ 0x80000000u));
 	    }
-
-	    Node* temp = lowerhull(plmax,plmin,T);
-	    map<pair<int, int>, int>m;
-	    cout<<"LH : \n";
-	    while(temp)
+	    else
 	    {
-	    	cout<<temp->p.first<<" "<<temp->p.second<<"\n";
-	        m[temp->p] = 0;
-	        temp=temp->next;
+	        a.pts.resize(n);
+	        for (int i = 0; i < n; i++)
+	            if (a.keep[i])
+	                a.pts[m++] = make_pair(a.xs[i], a.ys[i]);
+	        a.pts.resize(m);
+	        sort(a.pts.begin(), a.pts.end());
 	    }
-	    cout<<"LH ends : \n\n";
-	    auto it = m.rbegin();
-	    auto it1 = m.rbegin();
-	    fileout<<to_string(it->first.first) <<" "<< to_string(it->first.second)<<" "<<" 1\n";
-	    fileout << to_string(it->first.first) <<" "<< to_string(it->first.second)<<" ";
+	    n = m;
 
-	    cout<<it->first.first<<" "<<it->first.second<<endl;
-	    it++;
-	    for (; it != m.rend(); it++ )
+	    a.chain.resize(n + 1);
+	    int k = monotoneChainSorted(a.pts.data(), n, a.chain.data());
+	    for (int i = 0; i < k; i++)
 	    {
-	    	cout<<it->first.first<<" "<<it->first.second<<endl;
-	        fileout << to_string(it->first.first)  // string (key)
-	                  << " "
-	                  << to_string(it->first.second)
-	                  <<" 1\n";   // string's value 
-	                 
-	        fileout << to_string(it->first.first)  // string (key)
-	                  << " "
-	                  << to_string(it->first.second)
-	                  <<" ";
-
+	        a.out.push_back(a.chain[i].first);
+	        a.out.push_back(a.chain[i].second);
 	    }
-	    // fileout<<to_string(temp1->p.first)<<" "<<to_string(temp1->p.second)<<" 1\n";
-	    fileout.close();
+	    return k;
 	}
-
-	~KirkPatrickSeidel(){}
-	
 };